@@ -0,0 +1,33 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+      benchmark main file
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include "lib/benchmarks.h"
+
+/*
+Usage: ./bench [maxsize] [budget seconds] [name filter]
+       ./bench --memory [patients=1000000]
+Results are written to stdout as CSV, progress
+and skipped sizes are reported on stderr.
+*/
+int main(int argc, char** argv)
+{
+	std::size_t maxsize = 1000000;
+	double budget = 5.0;
+	const char* filter = nullptr;
+	if(argc > 1 && std::string(argv[1]) == "--memory")
+	{
+		runMemoryReport(std::cout, argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000);
+		return 0;
+	}
+	if(argc > 1) maxsize = std::strtoull(argv[1], nullptr, 10);
+	if(argc > 2) budget = std::strtod(argv[2], nullptr);
+	if(argc > 3) filter = argv[3];
+	runBenchmarks(std::cout, maxsize, budget, filter);
+	return 0;
+}
@@ -0,0 +1,112 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+   allocation counter source file
+*/
+
+#include "alloccount.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic<uint64_t> alloc_calls{0};
+std::atomic<uint64_t> alloc_bytes{0};
+
+void* countedAlloc(std::size_t size)
+{
+	alloc_calls.fetch_add(1, std::memory_order_relaxed);
+	alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	//malloc(0) may return null, operator new must not
+	void* ptr = std::malloc(size != 0 ? size : 1);
+	if(ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+
+//std::pmr::new_delete_resource() asks for explicitly aligned blocks
+void* countedAlignedAlloc(std::size_t size, std::align_val_t alignment)
+{
+	alloc_calls.fetch_add(1, std::memory_order_relaxed);
+	alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	std::size_t align = static_cast<std::size_t>(alignment);
+	//aligned_alloc wants a multiple of the alignment
+	std::size_t rounded = (size + align - 1) / align * align;
+	void* ptr = std::aligned_alloc(align, rounded != 0 ? rounded : align);
+	if(ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+
+}
+
+uint64_t allocationCount()
+{
+	return alloc_calls.load(std::memory_order_relaxed);
+}
+
+uint64_t allocatedBytes()
+{
+	return alloc_bytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size)
+{
+	return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return countedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return countedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
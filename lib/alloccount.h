@@ -0,0 +1,31 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+   allocation counter header file
+*/
+
+#ifndef ALLOCCOUNT_H
+#define ALLOCCOUNT_H
+
+#include <cstdint>
+
+/*
+Linking alloccount.cpp into a binary replaces the
+global operator new and delete with versions that
+count every heap allocation made by the program.
+The counters are process-wide and never reset;
+take a snapshot before and after the measured code.
+*/
+
+/*
+Returns the number of calls to operator new
+made so far by all threads.
+*/
+uint64_t allocationCount();
+/*
+Returns the total number of bytes requested
+from operator new so far by all threads.
+*/
+uint64_t allocatedBytes();
+
+#endif
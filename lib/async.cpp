@@ -0,0 +1,122 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+         async source file
+*/
+
+#include "async.h"
+
+scheduler::scheduler(unsigned threads)
+{
+	stopping = false;
+	if(threads == 0) threads = 1;
+	for(unsigned i = 0; i < threads; i++) workers.emplace_back(&scheduler::work, this);
+}
+
+scheduler::~scheduler()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	ready.notify_all();
+	for(std::thread& worker : workers) worker.join();
+}
+
+void scheduler::post(std::coroutine_handle<> handle)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		runnable.push_back(handle);
+	}
+	ready.notify_one();
+}
+
+void scheduler::work()
+{
+	while(true)
+	{
+		std::coroutine_handle<> next;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			ready.wait(guard, [this] { return stopping || !runnable.empty(); });
+			//leave only once everything posted has run
+			if(runnable.empty()) return;
+			next = runnable.front();
+			runnable.pop_front();
+		}
+		next.resume();
+	}
+}
+
+queuedcall::queuedcall(commandqueue& q, scheduler& s, std::function<bool(hospital&)> op)
+{
+	queue = &q;
+	sched = &s;
+	operation = std::move(op);
+	result = false;
+}
+
+void queuedcall::await_suspend(std::coroutine_handle<> handle)
+{
+	scheduler* resumer = sched;
+	bool* out = &result;
+	//the awaitable may be gone once the coroutine is posted, so only copies are used
+	queue -> post(std::move(operation), [resumer, out, handle](bool value)
+	{
+		*out = value;
+		resumer -> post(handle);
+	});
+}
+
+asynchospital::asynchospital(commandqueue& q, scheduler& s)
+{
+	queue = &q;
+	sched = &s;
+}
+
+queuedcall asynchospital::registerPatient(patient& ptn)
+{
+	return call([&ptn](hospital& hosp) { return hosp.registerPatient(ptn); });
+}
+
+queuedcall asynchospital::dischargePatient(patient& ptn)
+{
+	return call([&ptn](hospital& hosp) { return hosp.dischargePatient(ptn); });
+}
+
+queuedcall asynchospital::employStaff(staffmember& stm)
+{
+	return call([&stm](hospital& hosp) { return hosp.employStaff(stm); });
+}
+
+queuedcall asynchospital::dismissStaff(staffmember& stm)
+{
+	return call([&stm](hospital& hosp) { return hosp.dismissStaff(stm); });
+}
+
+queuedcall asynchospital::addPatient(room& rm, patient& ptn)
+{
+	return call([&rm, &ptn](hospital&) { return rm.addPatient(ptn); });
+}
+
+queuedcall asynchospital::removePatient(room& rm, patient& ptn)
+{
+	return call([&rm, &ptn](hospital&) { return rm.removePatient(ptn); });
+}
+
+task<census> asynchospital::snapshotCensus()
+{
+	census snapshot;
+	co_await call([&snapshot](hospital& hosp)
+	{
+		snapshot = hosp.getCensus();
+		return true;
+	});
+	co_return snapshot;
+}
+
+queuedcall asynchospital::call(std::function<bool(hospital&)> operation)
+{
+	return queuedcall(*queue, *sched, std::move(operation));
+}
@@ -0,0 +1,262 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+         async header file
+*/
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "objects.h"
+#include "commands.h"
+
+/*
+A small pool of threads resuming coroutines. A coroutine
+waiting for the hospital holds no thread, so thousands
+of logical requests can be in flight on a few threads.
+*/
+class scheduler
+{
+
+public:
+	/*
+	Starts the given number of worker threads (at least one).
+	*/
+	scheduler(unsigned threads = 2);
+	/*
+	Runs every coroutine already posted, then stops
+	the workers.
+	*/
+	~scheduler();
+	scheduler(const scheduler&) = delete;
+	scheduler& operator=(const scheduler&) = delete;
+	/*
+	Queues a suspended coroutine to be resumed by a worker.
+	*/
+	void post(std::coroutine_handle<> handle);
+	/*
+	Awaiting the result moves the coroutine onto a worker.
+	*/
+	auto schedule()
+	{
+		struct hop
+		{
+			scheduler* sched;
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> handle) { sched -> post(handle); }
+			void await_resume() const noexcept {}
+		};
+		return hop{this};
+	}
+
+private:
+	std::mutex lock;
+	std::condition_variable ready;
+	std::deque<std::coroutine_handle<>> runnable;
+	std::vector<std::thread> workers;
+	bool stopping;
+
+	void work();
+
+};
+
+/*
+A lazily started coroutine producing a T. It runs when
+first awaited and resumes the awaiting coroutine when it
+returns, on whatever thread finished it. Exceptions
+thrown inside are rethrown to the awaiting coroutine.
+*/
+template<class T>
+class task
+{
+
+public:
+	struct promise_type
+	{
+		T value;
+		std::exception_ptr error;
+		std::coroutine_handle<> continuation;
+
+		task get_return_object() { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		auto final_suspend() noexcept
+		{
+			//hand the thread straight to the awaiting coroutine
+			struct resumer
+			{
+				bool await_ready() const noexcept { return false; }
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> done) noexcept
+				{
+					std::coroutine_handle<> next = done.promise().continuation;
+					return next ? next : std::noop_coroutine();
+				}
+				void await_resume() const noexcept {}
+			};
+			return resumer{};
+		}
+		void return_value(T result) { value = std::move(result); }
+		void unhandled_exception() { error = std::current_exception(); }
+	};
+
+	task(task&& ref) noexcept : coro(std::exchange(ref.coro, nullptr)) {}
+	task(const task&) = delete;
+	task& operator=(const task&) = delete;
+	~task() { if(coro) coro.destroy(); }
+
+	bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		coro.promise().continuation = awaiting;
+		return coro;
+	}
+	T await_resume()
+	{
+		if(coro.promise().error) std::rethrow_exception(coro.promise().error);
+		return std::move(coro.promise().value);
+	}
+
+private:
+	explicit task(std::coroutine_handle<promise_type> handle) : coro(handle) {}
+	std::coroutine_handle<promise_type> coro;
+
+};
+
+/*
+Awaitable running one operation on the applier thread of
+a command queue. The awaiting coroutine is resumed on a
+scheduler worker with the result of the operation.
+*/
+class queuedcall
+{
+
+public:
+	queuedcall(commandqueue& q, scheduler& s, std::function<bool(hospital&)> op);
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle);
+	bool await_resume() const noexcept { return result; }
+
+private:
+	commandqueue* queue;
+	scheduler* sched;
+	std::function<bool(hospital&)> operation;
+	bool result;
+
+};
+
+/*
+Coroutine facade of a hospital. Every operation is
+applied through a command queue, so it is serialised
+with all other users of that queue, and resumes the
+awaiting coroutine on the scheduler:
+
+	task<bool> admit(asynchospital& hosp, patient& ptn, room& rm)
+	{
+		if(!co_await hosp.registerPatient(ptn)) co_return false;
+		co_return co_await hosp.addPatient(rm, ptn);
+	}
+
+Coroutines must not touch the hospital or its objects
+other than through the facade while the queue runs.
+*/
+class asynchospital
+{
+
+public:
+	/*
+	The queue and scheduler must outlive the facade and
+	every coroutine using it. Shut down in this order:
+
+	- queue.shutdown(), which applies what is queued and
+	  resumes its coroutines, answering any operation they
+	  start afterwards with false
+	- destroy the scheduler, which runs the coroutines left
+	  to their end
+	- destroy the queue
+
+	so declare the queue before the scheduler, and call
+	queue.shutdown() before leaving their scope unless
+	every coroutine has finished by then. Destroying the
+	queue first would leave coroutines resumed by the
+	scheduler posting to it.
+	*/
+	asynchospital(commandqueue& q, scheduler& s);
+	/*
+	Awaitable versions of the hospital and room methods,
+	resulting in what the synchronous method returns.
+	*/
+	queuedcall registerPatient(patient& ptn);
+	queuedcall dischargePatient(patient& ptn);
+	queuedcall employStaff(staffmember& stm);
+	queuedcall dismissStaff(staffmember& stm);
+	queuedcall addPatient(room& rm, patient& ptn);
+	queuedcall removePatient(room& rm, patient& ptn);
+	/*
+	Results in a copy of the census, consistent with
+	all operations queued before it.
+	*/
+	task<census> snapshotCensus();
+	/*
+	Runs any other function of the hospital in order
+	with the rest.
+	*/
+	queuedcall call(std::function<bool(hospital&)> operation);
+
+private:
+	commandqueue* queue;
+	scheduler* sched;
+
+};
+
+/*
+Coroutine started eagerly and destroyed when it ends,
+used to launch a task from ordinary code.
+*/
+struct detachedtask
+{
+	struct promise_type
+	{
+		detachedtask get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+/*
+Runs a task on a scheduler without waiting for it.
+The result is handed to done, if given.
+*/
+template<class T>
+detachedtask spawn(scheduler& sched, task<T> work, std::function<void(T)> done = nullptr)
+{
+	co_await sched.schedule();
+	T result = co_await work;
+	if(done) done(std::move(result));
+}
+
+/*
+Runs a task on a scheduler and blocks the calling
+thread until it finishes, returning its result.
+Must not be called from a scheduler worker.
+*/
+template<class T>
+T syncWait(scheduler& sched, task<T> work)
+{
+	std::promise<T> result;
+	std::future<T> ready = result.get_future();
+	spawn<T>(sched, std::move(work), [&result](T value) { result.set_value(std::move(value)); });
+	return ready.get();
+}
+
+#endif
@@ -0,0 +1,932 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+     benchmark source file
+*/
+
+#include "benchmarks.h"
+#include "objects.h"
+#include "alloccount.h"
+#include "generator.h"
+#include "columns.h"
+#include "conditions.h"
+#include "kernels.h"
+#include "census.h"
+#include "events.h"
+#include "commands.h"
+#include "async.h"
+#include "dedup.h"
+#include "simulation.h"
+#include <list>
+
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iomanip>
+#include <latch>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/*
+Stream buffer discarding everything written to it,
+used to time printing without a terminal.
+*/
+class nullbuffer : public std::streambuf
+{
+
+protected:
+	int overflow(int ch) override { return ch; }
+	std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+
+};
+
+/*
+Swaps std::cout for a discarding stream for the
+lifetime of the object.
+*/
+class mutedcout
+{
+
+public:
+	mutedcout() { saved = std::cout.rdbuf(&sink); }
+	~mutedcout() { std::cout.rdbuf(saved); }
+
+private:
+	nullbuffer sink;
+	std::streambuf* saved;
+
+};
+
+/*
+A set of entities and the hospital linking them.
+The hospital is declared last so it is destroyed
+first, before the objects it points to.
+*/
+struct population
+{
+	std::deque<room> rooms;
+	std::deque<staffmember> staff;
+	std::deque<patient> patients;
+	hospital hosp{"benchmark general"};
+
+	void makePatients(std::size_t count)
+	{
+		for(std::size_t i = 0; i < count; i++)
+		{
+			patients.emplace_back("John", "Doe" + std::to_string(i), int(i % 90));
+			patients.back().setCondition("observation");
+		}
+	}
+	void makeStaff(std::size_t count)
+	{
+		for(std::size_t i = 0; i < count; i++)
+		{
+			staff.emplace_back("Jane", "Roe" + std::to_string(i), 30 + int(i % 30));
+			staff.back().setType("nurse");
+		}
+	}
+	void makeRooms(std::size_t count)
+	{
+		for(std::size_t i = 0; i < count; i++)
+			rooms.emplace_back("ward " + std::to_string(i));
+	}
+	void registerAll()
+	{
+		for(patient& p : patients) hosp.registerPatient(p);
+	}
+};
+
+//pseudo-random visiting order, same for every run
+std::vector<std::size_t> shuffledOrder(std::size_t count)
+{
+	std::vector<std::size_t> order(count);
+	for(std::size_t i = 0; i < count; i++) order[i] = i;
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+	for(std::size_t i = count; i > 1; i--)
+	{
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		std::swap(order[i - 1], order[(state >> 33) % i]);
+	}
+	return order;
+}
+
+benchmeasure benchRegister(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	benchtimer timer;
+	timer.start();
+	for(patient& p : pop.patients) pop.hosp.registerPatient(p);
+	return timer.stop(size);
+}
+
+benchmeasure benchRegisterMonotonic(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	//the hospital containers grow in chunks which are never freed one by one
+	std::pmr::monotonic_buffer_resource arena;
+	hospital hosp("benchmark monotonic", &arena);
+	benchtimer timer;
+	timer.start();
+	for(patient& p : pop.patients) hosp.registerPatient(p);
+	return timer.stop(size);
+}
+
+benchmeasure benchRegisterFixed(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	hospitallimits lims;
+	lims.patients = size;
+	hospital hosp("benchmark fixed", lims);
+	//the first round hands out the arena, the timed one reuses it
+	for(patient& p : pop.patients) hosp.registerPatient(p);
+	for(patient& p : pop.patients) hosp.dischargePatient(p);
+	benchtimer timer;
+	timer.start();
+	for(patient& p : pop.patients) hosp.registerPatient(p);
+	return timer.stop(size);
+}
+
+benchmeasure benchLookup(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.registerAll();
+	std::vector<std::size_t> order = shuffledOrder(size);
+	std::vector<std::string> surnames;
+	for(std::size_t i : order) surnames.emplace_back(pop.patients[i].getSurname());
+	std::size_t found = 0;
+	benchtimer timer;
+	timer.start();
+	for(const std::string& sn : surnames)
+		if(pop.hosp.getPatient("John", sn).isValid()) found++;
+	benchmeasure res = timer.stop(size);
+	if(found != size) std::cerr << "bench lookup: missed " << size - found << " patients\n";
+	return res;
+}
+
+benchmeasure benchDischarge(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.registerAll();
+	std::vector<std::size_t> order = shuffledOrder(size);
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order) pop.hosp.dischargePatient(pop.patients[i]);
+	return timer.stop(size);
+}
+
+benchmeasure benchRoomAdd(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.makeRooms(1);
+	benchtimer timer;
+	timer.start();
+	for(patient& p : pop.patients) pop.rooms[0].addPatient(p);
+	return timer.stop(size);
+}
+
+benchmeasure benchRoomRemove(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.makeRooms(1);
+	for(patient& p : pop.patients) pop.rooms[0].addPatient(p);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order) pop.rooms[0].removePatient(pop.patients[i]);
+	return timer.stop(size);
+}
+
+benchmeasure benchEmploy(std::size_t size)
+{
+	population pop;
+	pop.makeStaff(size);
+	benchtimer timer;
+	timer.start();
+	for(staffmember& s : pop.staff) pop.hosp.employStaff(s);
+	return timer.stop(size);
+}
+
+benchmeasure benchDismiss(std::size_t size)
+{
+	population pop;
+	pop.makeStaff(size);
+	for(staffmember& s : pop.staff) pop.hosp.employStaff(s);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order) pop.hosp.dismissStaff(pop.staff[i]);
+	return timer.stop(size);
+}
+
+benchmeasure benchTransfer(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.makeRooms(2);
+	pop.hosp.addRoom(pop.rooms[0]);
+	pop.hosp.addRoom(pop.rooms[1]);
+	pop.registerAll();
+	for(patient& p : pop.patients) pop.rooms[0].addPatient(p);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order)
+	{
+		pop.rooms[0].removePatient(pop.patients[i]);
+		pop.rooms[1].addPatient(pop.patients[i]);
+	}
+	return timer.stop(size);
+}
+
+benchmeasure benchPrint(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.registerAll();
+	mutedcout mute;
+	benchtimer timer;
+	timer.start();
+	pop.hosp.printPatients();
+	return timer.stop(size);
+}
+
+benchmeasure benchDestroy(std::size_t size)
+{
+	std::deque<room> rooms;
+	std::deque<staffmember> staff;
+	std::deque<patient> patients;
+	hospital* hosp = new hospital("benchmark general");
+	for(std::size_t i = 0; i < size; i++)
+	{
+		patients.emplace_back("John", "Doe" + std::to_string(i), int(i % 90));
+		hosp -> registerPatient(patients.back());
+	}
+	for(std::size_t i = 0; i < size / 10 + 1; i++)
+	{
+		staff.emplace_back("Jane", "Roe" + std::to_string(i), 40);
+		staff.back().setType("nurse");
+		hosp -> employStaff(staff.back());
+		rooms.emplace_back("ward " + std::to_string(i));
+		hosp -> addRoom(rooms.back());
+	}
+	benchtimer timer;
+	timer.start();
+	delete hosp;
+	return timer.stop(size);
+}
+
+benchmeasure benchGenerate(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	benchtimer timer;
+	timer.start();
+	syntheticpopulation pop(config);
+	return timer.stop(size);
+}
+
+benchmeasure benchListMeanAge(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	//the pointer list a hospital keeps, walked through the getters
+	std::list<patient*> registered;
+	for(patient& p : pop.getPatients())
+		if(p.getHospital().isValid()) registered.push_back(&p);
+	benchtimer timer;
+	timer.start();
+	uint64_t sum = 0;
+	std::size_t count = 0;
+	for(patient* p : registered)
+	{
+		if(p -> getCondition() == "influenza")
+		{
+			sum += p -> getAge();
+			count++;
+		}
+	}
+	benchmeasure res = timer.stop(registered.size());
+	if(count > 0 && sum == 0) std::cerr << "bench list mean age: no ages\n";
+	return res;
+}
+
+benchmeasure benchColumnsMeanAge(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	patientcolumns cols;
+	pop.getHospital().attachColumns(cols);
+	uint32_t influenza = conditionId("influenza");
+	benchtimer timer;
+	timer.start();
+	double mean = cols.meanAge(influenza);
+	benchmeasure res = timer.stop(cols.size());
+	pop.getHospital().detachColumns();
+	if(mean < 0) std::cerr << "bench columns mean age: negative\n";
+	return res;
+}
+
+benchmeasure benchListAgeStats(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	std::list<patient*> registered;
+	for(patient& p : pop.getPatients())
+		if(p.getHospital().isValid()) registered.push_back(&p);
+	benchtimer timer;
+	timer.start();
+	uint64_t sum = 0;
+	int lowest = 255, highest = 0;
+	for(patient* p : registered)
+	{
+		int age = p -> getAge();
+		sum += age;
+		lowest = std::min(lowest, age);
+		highest = std::max(highest, age);
+	}
+	benchmeasure res = timer.stop(registered.size());
+	if(lowest > highest && sum != 0) std::cerr << "bench list age stats: bad range\n";
+	return res;
+}
+
+//age statistics over the columns at a forced kernel level
+benchmeasure kernelAgeStats(std::size_t size, kernellevel level)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	patientcolumns cols;
+	pop.getHospital().attachColumns(cols);
+	kernellevel saved = getKernelLevel();
+	setKernelLevel(level);
+	benchtimer timer;
+	timer.start();
+	agestats stats = ageStatsByHospital(cols, pop.getHospital());
+	benchmeasure res = timer.stop(cols.size());
+	setKernelLevel(saved);
+	pop.getHospital().detachColumns();
+	if(stats.count != res.ops) std::cerr << "bench kernel age stats: wrong count\n";
+	return res;
+}
+
+benchmeasure benchScalarAgeStats(std::size_t size)
+{
+	return kernelAgeStats(size, kernel_scalar);
+}
+
+benchmeasure benchSse2AgeStats(std::size_t size)
+{
+	return kernelAgeStats(size, kernel_sse2);
+}
+
+benchmeasure benchAvx2AgeStats(std::size_t size)
+{
+	return kernelAgeStats(size, kernel_avx2);
+}
+
+benchmeasure benchListAgeHistogram(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	std::list<patient*> registered;
+	for(patient& p : pop.getPatients())
+		if(p.getHospital().isValid()) registered.push_back(&p);
+	benchtimer timer;
+	timer.start();
+	std::vector<uint64_t> bins(21, 0);
+	for(patient* p : registered) bins[p -> getAge() / 10]++;
+	return timer.stop(registered.size());
+}
+
+benchmeasure kernelAgeHistogram(std::size_t size, unsigned binwidth)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	patientcolumns cols;
+	pop.getHospital().attachColumns(cols);
+	benchtimer timer;
+	timer.start();
+	std::vector<uint64_t> bins = ageHistogram(cols, pop.getHospital().getHandle().index, binwidth);
+	benchmeasure res = timer.stop(cols.size());
+	pop.getHospital().detachColumns();
+	return res;
+}
+
+benchmeasure benchKernelAgeHistogram(std::size_t size)
+{
+	return kernelAgeHistogram(size, 10);
+}
+
+//a bin per year, too many bounds for the SIMD kernels
+benchmeasure benchKernelAgeHistogramYears(std::size_t size)
+{
+	return kernelAgeHistogram(size, 1);
+}
+
+benchmeasure benchCensusAgeHistogram(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	const census& cns = pop.getHospital().getCensus();
+	benchtimer timer;
+	timer.start();
+	std::vector<uint64_t> bins(census::band_count, 0);
+	for(unsigned band = 0; band < census::band_count; band++) bins[band] = cns.inAgeBand(band);
+	//per patient, to compare with the scans above
+	return timer.stop(cns.patients());
+}
+
+benchmeasure benchCensusUpdate(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	std::deque<patient>& patients = pop.getPatients();
+	std::vector<std::size_t> order = shuffledOrder(patients.size());
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order) patients[i].setCondition("influenza");
+	return timer.stop(order.size());
+}
+
+benchmeasure benchFeed(std::size_t size)
+{
+	eventfeed feed(1 << 12, eventfeed::reject_newest);
+	eventsubscriber first(feed);
+	eventsubscriber second(feed);
+	hospitalevent batch[256];
+	entityhandle subject = {1, 1};
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i = 0; i < size; i++)
+	{
+		feed.publish(event_patient_registered, subject, subject, entityhandle());
+		//drain both subscribers in batches, as a consumer loop would
+		if((i & 255) == 255)
+		{
+			first.pollBatch(batch, 256);
+			second.pollBatch(batch, 256);
+		}
+	}
+	first.pollBatch(batch, 256);
+	second.pollBatch(batch, 256);
+	return timer.stop(size);
+}
+
+//threads submitting concurrently in the admission benchmarks
+const unsigned submitters = 4;
+
+benchmeasure benchLockedAdmission(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	std::mutex lock;
+	std::vector<std::thread> threads;
+	benchtimer timer;
+	timer.start();
+	for(unsigned t = 0; t < submitters; t++) threads.emplace_back([&, t]()
+	{
+		for(std::size_t i = t; i < size; i += submitters)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			pop.hosp.registerPatient(pop.patients[i]);
+		}
+	});
+	for(std::thread& th : threads) th.join();
+	return timer.stop(size);
+}
+
+benchmeasure benchQueuedAdmission(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	benchtimer timer;
+	timer.start();
+	{
+		commandqueue queue(pop.hosp);
+		std::vector<std::thread> threads;
+		for(unsigned t = 0; t < submitters; t++) threads.emplace_back([&, t]()
+		{
+			std::vector<std::future<bool>> results;
+			results.reserve(size / submitters + 1);
+			for(std::size_t i = t; i < size; i += submitters) results.push_back(queue.registerPatient(pop.patients[i]));
+			for(std::future<bool>& r : results) r.wait();
+		});
+		for(std::thread& th : threads) th.join();
+	}
+	return timer.stop(size);
+}
+
+task<bool> admitOne(asynchospital& async, patient& ptn)
+{
+	co_return co_await async.registerPatient(ptn);
+}
+
+benchmeasure benchAwaitedAdmission(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	benchtimer timer;
+	timer.start();
+	{
+		//every registration is a coroutine in flight at once, on two threads
+		commandqueue queue(pop.hosp);
+		scheduler sched(2);
+		asynchospital async(queue, sched);
+		std::latch done(size);
+		for(patient& p : pop.patients) spawn<bool>(sched, admitOne(async, p), [&done](bool) { done.count_down(); });
+		done.wait();
+	}
+	return timer.stop(size);
+}
+
+benchmeasure benchTriageAdmitNext(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.registerAll();
+	std::vector<std::size_t> order = shuffledOrder(size);
+	for(std::size_t i = 0; i < size; i++) pop.patients[i].setSeverity(order[i] % (max_severity + 1));
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order) pop.hosp.admitToTriage(pop.patients[i]);
+	while(pop.hosp.nextPatient().isValid());
+	//one admission and one call of the next patient per operation
+	return timer.stop(size);
+}
+
+benchmeasure benchTriageReprioritise(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.registerAll();
+	for(patient& p : pop.patients) pop.hosp.admitToTriage(p);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i : order) pop.patients[i].setSeverity(i % (max_severity + 1));
+	return timer.stop(size);
+}
+
+benchmeasure benchWaitlistHandoff(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	pop.makeRooms(1);
+	pop.registerAll();
+	room& single = pop.rooms[0];
+	pop.hosp.addRoom(single);
+	single.setCapacity(1);
+	for(patient& p : pop.patients) pop.hosp.waitForRoom(p, single);
+	benchtimer timer;
+	timer.start();
+	//every removal hands the bed to the next waiting patient
+	for(patient& p : pop.patients) single.removePatient(p);
+	return timer.stop(size);
+}
+
+benchmeasure benchFuzzySearch(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	//names of random patients, each with one letter mistyped
+	std::size_t queries = std::min<std::size_t>(size, 1000);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	std::vector<std::string> typed;
+	for(std::size_t i = 0; i < queries; i++)
+	{
+		const patient& p = pop.getPatients()[order[i]];
+		std::string name = std::string(p.getName()) + " " + std::string(p.getSurname());
+		name[i % name.size()] = 'x';
+		typed.push_back(name);
+	}
+	std::size_t found = 0;
+	benchtimer timer;
+	timer.start();
+	for(const std::string& q : typed) found += pop.getHospital().findPatients(q, 5).size();
+	benchmeasure measure = timer.stop(queries);
+	//keep the searches from being optimised out
+	if(found == 0) std::cerr << "no fuzzy matches" << std::endl;
+	return measure;
+}
+
+benchmeasure benchSurnameComplete(std::size_t size)
+{
+	populationconfig config;
+	config.patients = size;
+	config.rooms = size / 100 + 1;
+	syntheticpopulation pop(config);
+	//the first letters of the surnames of random patients
+	std::size_t queries = std::min<std::size_t>(size, 10000);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	std::vector<std::string> typed;
+	for(std::size_t i = 0; i < queries; i++)
+		typed.emplace_back(pop.getPatients()[order[i]].getSurname().substr(0, 1 + i % 4));
+	std::size_t found = 0;
+	benchtimer timer;
+	timer.start();
+	for(const std::string& q : typed) found += pop.getHospital().completePatients(q, 10).size();
+	benchmeasure measure = timer.stop(queries);
+	if(found == 0) std::cerr << "no surname matches" << std::endl;
+	return measure;
+}
+
+//inserts every patient, looks each up in shuffled order and erases them all again
+template <class Policy>
+benchmeasure benchRegistry(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	std::vector<std::size_t> order = shuffledOrder(size);
+	registry<patient, personkey, Policy> reg;
+	std::size_t found = 0;
+	benchtimer timer;
+	timer.start();
+	for(patient& p : pop.patients) reg.insert(p);
+	for(std::size_t i : order) found += reg.find(personkey::of(pop.patients[i])) != nullptr;
+	for(std::size_t i : order) reg.erase(pop.patients[i]);
+	benchmeasure measure = timer.stop(3 * size);
+	if(found != size) std::cerr << "registry lost patients" << std::endl;
+	return measure;
+}
+
+//searches 8 hospitals for the one in ten patients also entered, with another
+//spelling, in the next hospital
+template <unsigned Threads>
+benchmeasure benchDuplicates(std::size_t size)
+{
+	constexpr std::size_t sites = 8;
+	//the hospitals go first, before the patients they point to
+	std::deque<patient> patients;
+	std::deque<hospital> hospitals;
+	std::vector<const hospital*> searched;
+	for(std::size_t h = 0; h < sites; h++)
+	{
+		hospitals.emplace_back("site " + std::to_string(h));
+		searched.push_back(&hospitals.back());
+	}
+	for(std::size_t i = 0; i < size; i++)
+	{
+		std::size_t h = i % sites;
+		std::string surname = "Doe" + std::to_string(i);
+		//a tenth of the people went to the next hospital as well
+		if(i % 10 == 9) surname = "doe-" + std::to_string(i - 1);
+		patients.emplace_back("John", surname, int(i % 90));
+		if(i % 10 == 9) patients.back().setAge(int((i - 1) % 90));
+		hospitals[h].registerPatient(patients.back());
+	}
+	dedupconfig config;
+	config.threads = Threads;
+	benchtimer timer;
+	timer.start();
+	std::vector<duplicatepair> pairs = findDuplicates(searched, config);
+	benchmeasure measure = timer.stop(size);
+	if(pairs.size() != size / 10) std::cerr << "duplicate search found " << pairs.size() << " pairs" << std::endl;
+	return measure;
+}
+
+//simulates size arrivals at 40 a day into 20 rooms of 10 beds, loaded to
+//about 96%, on Replications threads of their own
+template <unsigned Replications>
+benchmeasure benchSimulation(std::size_t size)
+{
+	std::deque<room> rooms;
+	hospital layout("benchmark layout");
+	for(int i = 0; i < 20; i++)
+	{
+		rooms.emplace_back("ward " + std::to_string(i));
+		rooms.back().setCapacity(10);
+		layout.addRoom(rooms.back());
+	}
+	simulationconfig config;
+	config.days = size / 40.0;
+	config.arrivals = {distribution::exponential, 1 / 40.0, 0};
+	config.stay = {distribution::lognormal, 4.8, 3};
+	config.transfershare = 0.2;
+	benchtimer timer;
+	timer.start();
+	std::vector<simulationreport> reports = runReplications(layout, config, Replications, Replications);
+	uint64_t events = 0;
+	for(const simulationreport& r : reports) events += r.events;
+	return timer.stop(events);
+}
+
+//admits every patient the way the hospital does: a duplicate check, then the
+//insertion, into a registry sized up front like hospital::reserve does
+template <class Policy>
+benchmeasure benchIntake(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	registry<patient, personkey, Policy> reg;
+	std::size_t added = 0;
+	reg.reserve(size);
+	benchtimer timer;
+	timer.start();
+	for(patient& p : pop.patients)
+		if(!reg.contains(personkey::of(p))) added += reg.insert(p);
+	benchmeasure measure = timer.stop(size);
+	if(added != size) std::cerr << "intake lost patients" << std::endl;
+	return measure;
+}
+
+//sets the name, age and condition of every patient with the checks of Policy
+template <class Policy>
+benchmeasure benchSetters(std::size_t size)
+{
+	population pop;
+	pop.makePatients(size);
+	std::vector<std::string> surnames;
+	for(std::size_t i = 0; i < size; i++) surnames.push_back("Poe" + std::to_string(i));
+	std::size_t failed = 0;
+	benchtimer timer;
+	timer.start();
+	for(std::size_t i = 0; i < size; i++)
+	{
+		patient& p = pop.patients[i];
+		failed += !p.setName<Policy>("Jane", surnames[i]);
+		failed += !p.setAge<Policy>(int(i % 100));
+		failed += !p.setCondition<Policy>("flu");
+	}
+	benchmeasure measure = timer.stop(3 * size);
+	if(failed != 0) std::cerr << "setters failed" << std::endl;
+	return measure;
+}
+
+const benchcase benchcases[] =
+{
+	{"patient_register", benchRegister},
+	{"patient_register_monotonic", benchRegisterMonotonic},
+	{"patient_register_fixed", benchRegisterFixed},
+	{"patient_lookup", benchLookup},
+	{"patient_discharge", benchDischarge},
+	{"room_add_patient", benchRoomAdd},
+	{"room_remove_patient", benchRoomRemove},
+	{"staff_employ", benchEmploy},
+	{"staff_dismiss", benchDismiss},
+	{"patient_transfer", benchTransfer},
+	{"hospital_print_patients", benchPrint},
+	{"hospital_destroy", benchDestroy},
+	{"population_generate", benchGenerate},
+	{"list_mean_age_by_condition", benchListMeanAge},
+	{"columns_mean_age_by_condition", benchColumnsMeanAge},
+	{"list_age_stats", benchListAgeStats},
+	{"kernel_age_stats_scalar", benchScalarAgeStats},
+	{"kernel_age_stats_sse2", benchSse2AgeStats},
+	{"kernel_age_stats_avx2", benchAvx2AgeStats},
+	{"list_age_histogram", benchListAgeHistogram},
+	{"kernel_age_histogram", benchKernelAgeHistogram},
+	{"kernel_age_histogram_width1", benchKernelAgeHistogramYears},
+	{"census_age_histogram", benchCensusAgeHistogram},
+	{"patient_set_condition", benchCensusUpdate},
+	{"feed_publish_poll", benchFeed},
+	{"patient_register_locked_4threads", benchLockedAdmission},
+	{"patient_register_queued_4threads", benchQueuedAdmission},
+	{"patient_register_awaited_2threads", benchAwaitedAdmission},
+	{"triage_admit_next", benchTriageAdmitNext},
+	{"triage_reprioritise", benchTriageReprioritise},
+	{"waitlist_handoff", benchWaitlistHandoff},
+	{"patient_fuzzy_search", benchFuzzySearch},
+	{"patient_surname_complete", benchSurnameComplete},
+	{"registry_list", benchRegistry<listpolicy>},
+	{"registry_vector", benchRegistry<vectorpolicy>},
+	{"registry_ordered", benchRegistry<orderedpolicy>},
+	{"registry_sharded", benchRegistry<shardedpolicy<listpolicy, 16>>},
+	{"registry_filtered", benchRegistry<filteredpolicy<listpolicy>>},
+	{"registry_intake_list", benchIntake<listpolicy>},
+	{"registry_intake_filtered", benchIntake<filteredpolicy<listpolicy>>},
+	{"duplicates_sort_merge_1thread", benchDuplicates<1>},
+	{"duplicates_sort_merge_4threads", benchDuplicates<4>},
+	{"simulation_patient_flow", benchSimulation<1>},
+	{"simulation_replications_4threads", benchSimulation<4>},
+	{"person_set_checked", benchSetters<checkedinput>},
+	{"person_set_trusted", benchSetters<trustedinput>},
+};
+
+double elapsedSince(std::chrono::steady_clock::time_point begin)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}
+
+void benchtimer::start()
+{
+	allocs = allocationCount();
+	begin = std::chrono::steady_clock::now();
+}
+
+benchmeasure benchtimer::stop(std::size_t ops)
+{
+	double seconds = elapsedSince(begin);
+	return {ops, seconds, allocationCount() - allocs};
+}
+
+void runMemoryReport(std::ostream& out, std::size_t count)
+{
+	populationconfig config;
+	config.patients = count;
+	config.rooms = count / 100 + 1;
+	uint64_t before = allocatedBytes();
+	syntheticpopulation pop(config);
+	double hospitalbytes = double(allocatedBytes() - before) / count;
+	double containerbytes = double(pop.getHospital().getMemory().bytesInUse()) / count;
+	//the layout of a patient before names went inline
+	struct stringrecord
+	{
+		std::string name;
+		std::string surname;
+		int age;
+		std::string condition;
+		int severity;
+		hospital* in_hospital;
+		room* in_room;
+		entityhandle self;
+	};
+	std::vector<stringrecord> strings;
+	strings.reserve(count);
+	//both layouts pay for a handle table slot
+	handletable<stringrecord> stringhandles;
+	before = allocatedBytes();
+	for(const patient& p : pop.getPatients())
+	{
+		strings.push_back({std::string(p.getName()), std::string(p.getSurname()), p.getAge(), p.getCondition(), p.getSeverity(), nullptr, nullptr, {}});
+		strings.back().self = stringhandles.acquire(&strings.back());
+	}
+	double stringheap = double(allocatedBytes() - before) / count;
+	std::vector<patient> compact;
+	compact.reserve(count);
+	before = allocatedBytes();
+	for(const patient& p : pop.getPatients()) compact.emplace_back(p);
+	double compactheap = double(allocatedBytes() - before) / count;
+	out << "layout,patients,record_bytes,heap_bytes_per_patient,bytes_per_patient" << std::endl;
+	out << std::fixed << std::setprecision(1);
+	out << "string_record," << count << "," << sizeof(stringrecord) << "," << stringheap << ","
+		<< sizeof(stringrecord) + stringheap << std::endl;
+	out << "compact_record," << count << "," << sizeof(patient) << "," << compactheap << ","
+		<< sizeof(patient) + compactheap << std::endl;
+	out << "synthetic_hospital," << count << ",," << hospitalbytes << "," << hospitalbytes << std::endl;
+	out << "hospital_containers," << count << ",," << containerbytes << "," << containerbytes << std::endl;
+}
+
+void runBenchmarks(std::ostream& out, std::size_t maxsize, double budget, const char* filter)
+{
+	out << "benchmark,size,ops,ns_per_op,allocs_per_op,ops_per_sec" << std::endl;
+	for(const benchcase& bc : benchcases)
+	{
+		if(filter != nullptr && std::strstr(bc.name, filter) == nullptr) continue;
+		double previous = 0;
+		for(std::size_t size = 10; size <= maxsize; size *= 10)
+		{
+			//total time includes setup and teardown of the case
+			auto begin = std::chrono::steady_clock::now();
+			benchmeasure m = bc.run(size);
+			double total = elapsedSince(begin);
+			double ops = m.ops != 0 ? double(m.ops) : 1;
+			out << bc.name << "," << size << "," << m.ops << std::fixed
+			<< "," << std::setprecision(1) << m.seconds * 1e9 / ops
+			<< "," << std::setprecision(3) << m.allocs / ops
+			<< "," << std::setprecision(0) << (m.seconds > 0 ? ops / m.seconds : 0)
+			<< std::defaultfloat << std::endl;
+			//extrapolate the growth seen between the last two sizes
+			double growth = previous > 0 ? total / previous : 10;
+			if(growth < 10) growth = 10;
+			if(total * growth > budget && size * 10 <= maxsize)
+			{
+				std::cerr << "bench: skipping " << bc.name << " above size " << size
+				<< " (predicted " << total * growth << " s)" << std::endl;
+				break;
+			}
+			previous = total;
+		}
+	}
+}
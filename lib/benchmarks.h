@@ -0,0 +1,87 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+     benchmark header file
+*/
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+/*
+Measurement of a single benchmark run. Only the
+code between benchtimer::start and benchtimer::stop
+is included, setup and teardown are not.
+*/
+struct benchmeasure
+{
+	//number of operations performed in the timed region
+	std::size_t ops;
+	//wall time of the timed region
+	double seconds;
+	//heap allocations made in the timed region
+	uint64_t allocs;
+};
+
+/*
+Helper used by benchmark cases to take
+clock and allocation counter snapshots.
+*/
+class benchtimer
+{
+
+public:
+	/*
+	Takes the starting snapshot.
+	*/
+	void start();
+	/*
+	Takes the final snapshot and returns the
+	measurement for a given number of operations.
+	*/
+	benchmeasure stop(std::size_t ops);
+
+private:
+	std::chrono::steady_clock::time_point begin;
+	uint64_t allocs;
+
+};
+
+/*
+A named benchmark case. The run function builds
+whatever it needs for a population of 'size'
+entities and times only the operation under test.
+*/
+struct benchcase
+{
+	const char* name;
+	benchmeasure (*run)(std::size_t size);
+};
+
+/*
+Runs every benchmark case at sizes 10, 100, ...
+up to maxsize and writes one CSV record per run:
+benchmark,size,ops,ns_per_op,allocs_per_op,ops_per_sec
+Larger sizes of a case are skipped once the next run
+is predicted to take longer than budget seconds, which
+keeps quadratic operations from stalling the suite.
+Only cases whose name contains filter are run.
+*/
+void runBenchmarks(std::ostream& out, std::size_t maxsize, double budget, const char* filter);
+/*
+Builds count synthetic patients in two record layouts, the
+std::string based one patients had before and the compact
+patient class, and writes one CSV record per layout:
+layout,patients,record_bytes,heap_bytes_per_patient,bytes_per_patient
+followed by the bytes allocated per patient for a whole
+synthetic hospital of that size, indexes included, and
+the part of it the hospital lists and indexes hold (as
+counted by hospital::getMemory).
+*/
+void runMemoryReport(std::ostream& out, std::size_t count);
+
+#endif
@@ -0,0 +1,120 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        census source file
+*/
+
+#include "census.h"
+#include "objects.h"
+#include "conditions.h"
+
+census::census(std::pmr::memory_resource* resource) : conditions(resource), roomed(resource)
+{
+	patientcount = 0;
+	unroomed = 0;
+	roomcount = 0;
+	staffed = 0;
+	for(uint64_t& band : bands) band = 0;
+	//healthy patients are always counted under ID 0
+	conditions.resize(1, 0);
+}
+
+uint64_t census::patients() const
+{
+	return patientcount;
+}
+
+uint64_t census::healthy() const
+{
+	return conditions[0];
+}
+
+uint64_t census::ill() const
+{
+	return patientcount - conditions[0];
+}
+
+uint64_t census::withCondition(std::string_view conditionstr) const
+{
+	return withCondition(conditionId(conditionstr));
+}
+
+uint64_t census::withCondition(uint32_t id) const
+{
+	if(id >= conditions.size()) return 0;
+	return conditions[id];
+}
+
+uint64_t census::inAgeBand(unsigned band) const
+{
+	if(band >= band_count) return 0;
+	return bands[band];
+}
+
+uint64_t census::inRoom(const room& rm) const
+{
+	auto found = roomed.find(rm.getHandle().index);
+	if(found == roomed.end()) return 0;
+	return found -> second;
+}
+
+uint64_t census::withoutRoom() const
+{
+	return unroomed;
+}
+
+uint64_t census::rooms() const
+{
+	return roomcount;
+}
+
+uint64_t census::staffedRooms() const
+{
+	return staffed;
+}
+
+uint64_t census::unstaffedRooms() const
+{
+	return roomcount - staffed;
+}
+
+void census::countPatient(const patient& ptn, int64_t delta)
+{
+	patientcount += delta;
+	uint32_t id = ptn.getConditionId();
+	if(id >= conditions.size()) conditions.resize(id + 1, 0);
+	conditions[id] += delta;
+	unsigned band = unsigned(ptn.getAge()) / band_width;
+	if(band < band_count) bands[band] += delta;
+	const room& rm = ptn.getRoom();
+	if(rm.isValid())
+	{
+		uint64_t& inroom = roomed[rm.getHandle().index];
+		inroom += delta;
+		//drop rooms which became empty, so the map stays small
+		if(inroom == 0) roomed.erase(rm.getHandle().index);
+	}
+	else unroomed += delta;
+}
+
+void census::addPatient(const patient& ptn)
+{
+	countPatient(ptn, 1);
+}
+
+void census::removePatient(const patient& ptn)
+{
+	countPatient(ptn, -1);
+}
+
+void census::addRoom(const room& rm)
+{
+	roomcount++;
+	if(rm.getStaff().isValid()) staffed++;
+}
+
+void census::removeRoom(const room& rm)
+{
+	roomcount--;
+	if(rm.getStaff().isValid()) staffed--;
+}
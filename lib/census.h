@@ -0,0 +1,98 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        census header file
+*/
+
+#ifndef CENSUS_H
+#define CENSUS_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class patient;
+class room;
+
+/*
+Running aggregates of a hospital. Every hospital keeps one
+and updates it in O(1) on each change of its patients and
+rooms, so all reads below take constant time no matter
+how many patients are registered.
+*/
+class census
+{
+
+public:
+	//width and number of the age bands, covering ages up to 209
+	static constexpr unsigned band_width = 10;
+	static constexpr unsigned band_count = 21;
+
+	/*
+	Starts with everything at zero. The counts grow in
+	memory taken from the given resource.
+	*/
+	census(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/*
+	Returns the number of registered patients.
+	*/
+	uint64_t patients() const;
+	/*
+	Return the number of patients without and with
+	a condition.
+	*/
+	uint64_t healthy() const;
+	uint64_t ill() const;
+	/*
+	Returns the number of patients with a condition,
+	given by name or by conditionId().
+	*/
+	uint64_t withCondition(std::string_view conditionstr) const;
+	uint64_t withCondition(uint32_t id) const;
+	/*
+	Returns the number of patients aged within
+	[band*band_width; (band+1)*band_width).
+	*/
+	uint64_t inAgeBand(unsigned band) const;
+	/*
+	Returns the number of registered patients placed
+	in a room, and of those not placed in any.
+	*/
+	uint64_t inRoom(const room& rm) const;
+	uint64_t withoutRoom() const;
+	/*
+	Return the number of rooms, and how many of them
+	have a caretaker linked.
+	*/
+	uint64_t rooms() const;
+	uint64_t staffedRooms() const;
+	uint64_t unstaffedRooms() const;
+
+	/*
+	Add or remove the contribution of an object to
+	the aggregates. Called by the hospital, with the
+	object data as it was when it was added.
+	*/
+	void addPatient(const patient& ptn);
+	void removePatient(const patient& ptn);
+	void addRoom(const room& rm);
+	void removeRoom(const room& rm);
+
+private:
+	uint64_t patientcount;
+	uint64_t unroomed;
+	uint64_t roomcount;
+	uint64_t staffed;
+	//condition ID -> patients, grows with new IDs
+	std::pmr::vector<uint64_t> conditions;
+	uint64_t bands[band_count];
+	//room handle index -> patients
+	std::pmr::unordered_map<uint32_t, uint64_t> roomed;
+
+	void countPatient(const patient& ptn, int64_t delta);
+
+};
+
+#endif
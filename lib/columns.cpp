@@ -0,0 +1,133 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+    patient columns source file
+*/
+
+#include "columns.h"
+#include "objects.h"
+#include "conditions.h"
+
+std::size_t patientcolumns::size() const
+{
+	return owner.size();
+}
+
+const uint8_t* patientcolumns::ages() const
+{
+	return age.data();
+}
+
+const uint32_t* patientcolumns::conditions() const
+{
+	return condition.data();
+}
+
+const uint32_t* patientcolumns::rooms() const
+{
+	return roomid.data();
+}
+
+const uint32_t* patientcolumns::hospitals() const
+{
+	return hospitalid.data();
+}
+
+entityhandle patientcolumns::patientAt(std::size_t row) const
+{
+	if(row >= owner.size()) return entityhandle();
+	return owner[row];
+}
+
+void patientcolumns::fill(std::size_t row, const patient& ptn)
+{
+	age[row] = uint8_t(ptn.getAge());
+	condition[row] = ptn.getConditionId();
+	//empty objects have handles too, so check validity first
+	roomid[row] = ptn.getRoom().isValid() ? ptn.getRoom().getHandle().index : 0;
+	hospitalid[row] = ptn.getHospital().isValid() ? ptn.getHospital().getHandle().index : 0;
+}
+
+void patientcolumns::insert(const patient& ptn)
+{
+	entityhandle handle = ptn.getHandle();
+	if(handle.isNull()) return;
+	if(handle.index >= rowof.size()) rowof.resize(handle.index + 1, no_row);
+	//already present, only refresh the values
+	if(rowof[handle.index] != no_row)
+	{
+		fill(rowof[handle.index], ptn);
+		return;
+	}
+	rowof[handle.index] = owner.size();
+	owner.push_back(handle);
+	age.push_back(0);
+	condition.push_back(0);
+	roomid.push_back(0);
+	hospitalid.push_back(0);
+	fill(owner.size() - 1, ptn);
+}
+
+void patientcolumns::update(const patient& ptn)
+{
+	entityhandle handle = ptn.getHandle();
+	if(!contains(ptn)) return;
+	fill(rowof[handle.index], ptn);
+}
+
+bool patientcolumns::erase(const patient& ptn)
+{
+	if(!contains(ptn)) return false;
+	uint32_t row = rowof[ptn.getHandle().index];
+	std::size_t last = owner.size() - 1;
+	//move the last row into the hole
+	if(row != last)
+	{
+		age[row] = age[last];
+		condition[row] = condition[last];
+		roomid[row] = roomid[last];
+		hospitalid[row] = hospitalid[last];
+		owner[row] = owner[last];
+		rowof[owner[row].index] = row;
+	}
+	age.pop_back();
+	condition.pop_back();
+	roomid.pop_back();
+	hospitalid.pop_back();
+	owner.pop_back();
+	rowof[ptn.getHandle().index] = no_row;
+	return true;
+}
+
+bool patientcolumns::contains(const patient& ptn) const
+{
+	entityhandle handle = ptn.getHandle();
+	if(handle.isNull() || handle.index >= rowof.size()) return false;
+	uint32_t row = rowof[handle.index];
+	//the slot may belong to a newer patient than the row
+	return row != no_row && owner[row] == handle;
+}
+
+double patientcolumns::meanAge(uint32_t cond) const
+{
+	uint64_t sum = 0;
+	std::size_t count = 0;
+	const std::size_t rows = owner.size();
+	for(std::size_t i = 0; i < rows; i++)
+	{
+		//branch free, so the loop can be vectorised
+		bool match = condition[i] == cond;
+		sum += match ? age[i] : 0;
+		count += match;
+	}
+	return count != 0 ? double(sum) / count : 0;
+}
+
+double patientcolumns::unroomedShare() const
+{
+	if(owner.empty()) return 0;
+	std::size_t count = 0;
+	const std::size_t rows = owner.size();
+	for(std::size_t i = 0; i < rows; i++) count += (roomid[i] == 0);
+	return double(count) / rows;
+}
@@ -0,0 +1,98 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+    patient columns header file
+*/
+
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include <cstdint>
+#include <vector>
+#include "handles.h"
+
+class patient;
+
+/*
+A columnar (structure-of-arrays) mirror of registered
+patients for analytic scans. Each patient is one row,
+spread over contiguous arrays of age, condition ID,
+room ID and hospital ID, so a scan reads only the
+columns it needs, without chasing list nodes.
+
+Room and hospital IDs are the slot indexes of their
+handles, 0 meaning none (slot 0 is never issued).
+Condition IDs come from conditionId(), 0 is healthy.
+Row order is unspecified, removal moves the last row
+into the freed one.
+
+The store is filled and kept current by every hospital
+it is attached to (see hospital::attachColumns), so
+rows of several hospitals may share one store. It is
+not safe to scan while an attached hospital changes.
+*/
+class patientcolumns
+{
+
+public:
+	/*
+	Returns the number of rows.
+	*/
+	std::size_t size() const;
+	/*
+	Column arrays, each holding size() values.
+	*/
+	const uint8_t* ages() const;
+	const uint32_t* conditions() const;
+	const uint32_t* rooms() const;
+	const uint32_t* hospitals() const;
+	/*
+	Returns the handle of the patient in a given row.
+	*/
+	entityhandle patientAt(std::size_t row) const;
+	/*
+	Adds a row for the patient, or refreshes it if the
+	patient is already present. Reads the current age,
+	condition, room and hospital of the patient.
+	*/
+	void insert(const patient& ptn);
+	/*
+	Refreshes the row of a patient. Does nothing if
+	the patient has no row.
+	*/
+	void update(const patient& ptn);
+	/*
+	Removes the row of a patient, returns false if
+	the patient has no row.
+	*/
+	bool erase(const patient& ptn);
+	/*
+	Checks if a patient has a row.
+	*/
+	bool contains(const patient& ptn) const;
+	/*
+	Average age of patients with a given condition ID,
+	0 if there are none.
+	*/
+	double meanAge(uint32_t condition) const;
+	/*
+	Share of rows without a room, 0 if the store is empty.
+	*/
+	double unroomedShare() const;
+
+private:
+	//row -> value
+	std::vector<uint8_t> age;
+	std::vector<uint32_t> condition;
+	std::vector<uint32_t> roomid;
+	std::vector<uint32_t> hospitalid;
+	std::vector<entityhandle> owner;
+	//patient handle index -> row, or no_row
+	std::vector<uint32_t> rowof;
+
+	static constexpr uint32_t no_row = UINT32_MAX;
+	void fill(std::size_t row, const patient& ptn);
+
+};
+
+#endif
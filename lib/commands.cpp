@@ -0,0 +1,257 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       commands source file
+*/
+
+#include "commands.h"
+#include <vector>
+
+commandqueue::commandqueue(hospital& hs, std::size_t maxbatch)
+{
+	hosp = &hs;
+	batchlimit = maxbatch > 0 ? maxbatch : 1;
+	stub.next.store(nullptr, std::memory_order_relaxed);
+	head.store(&stub, std::memory_order_relaxed);
+	tail = &stub;
+	appliedcount = 0;
+	batchcount = 0;
+	stopping = false;
+	sleeping = false;
+	closed = false;
+	entering = 0;
+	applier = std::thread(&commandqueue::run, this);
+}
+
+commandqueue::~commandqueue()
+{
+	shutdown();
+}
+
+std::future<bool> commandqueue::registerPatient(patient& ptn)
+{
+	command* cmd = new command();
+	cmd -> kind = command_register;
+	cmd -> ptn = &ptn;
+	return push(cmd);
+}
+
+std::future<bool> commandqueue::dischargePatient(patient& ptn)
+{
+	command* cmd = new command();
+	cmd -> kind = command_discharge;
+	cmd -> ptn = &ptn;
+	return push(cmd);
+}
+
+std::future<bool> commandqueue::employStaff(staffmember& stm)
+{
+	command* cmd = new command();
+	cmd -> kind = command_employ;
+	cmd -> stm = &stm;
+	return push(cmd);
+}
+
+std::future<bool> commandqueue::dismissStaff(staffmember& stm)
+{
+	command* cmd = new command();
+	cmd -> kind = command_dismiss;
+	cmd -> stm = &stm;
+	return push(cmd);
+}
+
+std::future<bool> commandqueue::addPatient(room& rm, patient& ptn)
+{
+	command* cmd = new command();
+	cmd -> kind = command_add;
+	cmd -> rm = &rm;
+	cmd -> ptn = &ptn;
+	return push(cmd);
+}
+
+std::future<bool> commandqueue::removePatient(room& rm, patient& ptn)
+{
+	command* cmd = new command();
+	cmd -> kind = command_remove;
+	cmd -> rm = &rm;
+	cmd -> ptn = &ptn;
+	return push(cmd);
+}
+
+std::future<bool> commandqueue::submit(std::function<bool(hospital&)> operation)
+{
+	command* cmd = new command();
+	cmd -> kind = command_call;
+	cmd -> operation = std::move(operation);
+	return push(cmd);
+}
+
+void commandqueue::post(std::function<bool(hospital&)> operation, std::function<void(bool)> done)
+{
+	command* cmd = new command();
+	cmd -> kind = command_call;
+	cmd -> operation = std::move(operation);
+	cmd -> done = std::move(done);
+	if(admit(cmd)) return;
+	std::function<void(bool)> refused = std::move(cmd -> done);
+	delete cmd;
+	refused(false);
+}
+
+void commandqueue::flush()
+{
+	//everything pushed before this no-op is applied before it
+	submit([](hospital&) { return true; }).wait();
+}
+
+uint64_t commandqueue::applied() const
+{
+	return appliedcount.load(std::memory_order_relaxed);
+}
+
+uint64_t commandqueue::batches() const
+{
+	return batchcount.load(std::memory_order_relaxed);
+}
+
+void commandqueue::shutdown()
+{
+	//a producer counts itself in before it reads closed, so once the count
+	//drops to zero nothing more can be enqueued
+	closed = true;
+	while(entering.load() != 0) std::this_thread::yield();
+	stopping = true;
+	{
+		std::lock_guard<std::mutex> lock(wakelock);
+		wake.notify_one();
+	}
+	if(applier.joinable()) applier.join();
+}
+
+std::future<bool> commandqueue::push(command* cmd)
+{
+	std::future<bool> result = cmd -> result.get_future();
+	if(!admit(cmd))
+	{
+		cmd -> result.set_value(false);
+		delete cmd;
+	}
+	return result;
+}
+
+bool commandqueue::admit(command* cmd)
+{
+	entering++;
+	bool open = !closed;
+	if(open)
+	{
+		enqueue(cmd);
+		wakeApplier();
+	}
+	entering--;
+	return open;
+}
+
+void commandqueue::wakeApplier()
+{
+	//only a sleeping applier needs the (comparatively slow) notification
+	if(sleeping.load())
+	{
+		std::lock_guard<std::mutex> lock(wakelock);
+		wake.notify_one();
+	}
+}
+
+void commandqueue::enqueue(command* cmd)
+{
+	cmd -> next.store(nullptr, std::memory_order_relaxed);
+	command* prev = head.exchange(cmd);
+	prev -> next.store(cmd, std::memory_order_release);
+}
+
+commandqueue::command* commandqueue::pop()
+{
+	command* first = tail;
+	command* next = first -> next.load(std::memory_order_acquire);
+	//skip the stub node
+	if(first == &stub)
+	{
+		if(next == nullptr) return nullptr;
+		tail = next;
+		first = next;
+		next = next -> next.load(std::memory_order_acquire);
+	}
+	if(next != nullptr)
+	{
+		tail = next;
+		return first;
+	}
+	//a producer swapped in a node but has not linked it yet
+	if(first != head.load()) return nullptr;
+	//first is the last node, put the stub behind it to take it out
+	enqueue(&stub);
+	next = first -> next.load(std::memory_order_acquire);
+	if(next != nullptr)
+	{
+		tail = next;
+		return first;
+	}
+	return nullptr;
+}
+
+bool commandqueue::apply(command* cmd)
+{
+	switch(cmd -> kind)
+	{
+		case command_register: return hosp -> registerPatient(*cmd -> ptn);
+		case command_discharge: return hosp -> dischargePatient(*cmd -> ptn);
+		case command_employ: return hosp -> employStaff(*cmd -> stm);
+		case command_dismiss: return hosp -> dismissStaff(*cmd -> stm);
+		case command_add: return cmd -> rm -> addPatient(*cmd -> ptn);
+		case command_remove: return cmd -> rm -> removePatient(*cmd -> ptn);
+		default: return cmd -> operation(*hosp);
+	}
+}
+
+void commandqueue::run()
+{
+	std::vector<command*> batch;
+	batch.reserve(batchlimit);
+	while(true)
+	{
+		batch.clear();
+		std::size_t registrations = 0;
+		command* cmd;
+		while(batch.size() < batchlimit && (cmd = pop()) != nullptr)
+		{
+			batch.push_back(cmd);
+			if(cmd -> kind == command_register) registrations++;
+		}
+		if(batch.empty())
+		{
+			if(stopping) break;
+			//sleep until a producer wakes us. A producer swaps head before it
+			//reads sleeping, so either it sees us asleep and notifies, or we
+			//see head moved off the stub and stay awake
+			sleeping = true;
+			{
+				std::unique_lock<std::mutex> lock(wakelock);
+				wake.wait(lock, [this] { return stopping || tail != &stub || head.load() != &stub; });
+			}
+			sleeping = false;
+			continue;
+		}
+		//grow the patient index once per batch instead of during it
+		if(registrations > 0) hosp -> reservePatients(hosp -> getCensus().patients() + registrations);
+		batchcount.fetch_add(1, std::memory_order_relaxed);
+		for(command* c : batch)
+		{
+			bool result = apply(c);
+			//counted before the future is ready, so waiters see it
+			appliedcount.fetch_add(1, std::memory_order_relaxed);
+			if(c -> done) c -> done(result);
+			else c -> result.set_value(result);
+			delete c;
+		}
+	}
+}
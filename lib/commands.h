@@ -0,0 +1,143 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       commands header file
+*/
+
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "objects.h"
+
+/*
+Asynchronous access to a hospital. Any number of threads
+submit operations, which are pushed onto a lock-free
+multi-producer single-consumer queue and return at once
+with a future. One applier thread owned by the queue
+drains it in batches and applies the operations in
+submission order (per producer), fulfilling the futures
+with the result of the matching hospital method.
+
+While a queue is running it is the only thing allowed to
+change its hospital and the objects linked to it; reads
+from other threads must go through the queue as well
+(see submit) or wait for flush().
+*/
+class commandqueue
+{
+
+public:
+	/*
+	Starts the applier thread. A batch holds up to
+	maxbatch operations.
+	*/
+	commandqueue(hospital& hosp, std::size_t maxbatch = 256);
+	/*
+	Shuts the queue down (see shutdown).
+	*/
+	~commandqueue();
+	commandqueue(const commandqueue&) = delete;
+	commandqueue& operator=(const commandqueue&) = delete;
+	/*
+	Queue the matching hospital or room operation. The
+	future holds what the synchronous method returns.
+	*/
+	std::future<bool> registerPatient(patient& ptn);
+	std::future<bool> dischargePatient(patient& ptn);
+	std::future<bool> employStaff(staffmember& stm);
+	std::future<bool> dismissStaff(staffmember& stm);
+	std::future<bool> addPatient(room& rm, patient& ptn);
+	std::future<bool> removePatient(room& rm, patient& ptn);
+	/*
+	Queues any other function of the hospital, run on
+	the applier thread in order with the rest.
+	*/
+	std::future<bool> submit(std::function<bool(hospital&)> operation);
+	/*
+	Like submit, but instead of fulfilling a future it
+	calls done with the result, on the applier thread.
+	Used to resume coroutines (see asynchospital).
+	*/
+	void post(std::function<bool(hospital&)> operation, std::function<void(bool)> done);
+	/*
+	Blocks until everything submitted before the call
+	has been applied.
+	*/
+	void flush();
+	/*
+	Return the number of operations applied, and of
+	batches they were applied in.
+	*/
+	uint64_t applied() const;
+	uint64_t batches() const;
+	/*
+	Stops taking operations, applies everything already
+	queued and stops the applier thread. Operations
+	submitted later are not applied: their futures hold
+	false, and posted ones have done called with false
+	on the calling thread. Must not be called from an
+	operation. Later calls do nothing.
+	*/
+	void shutdown();
+
+private:
+	enum commandkind
+	{
+		command_register,
+		command_discharge,
+		command_employ,
+		command_dismiss,
+		command_add,
+		command_remove,
+		command_call
+	};
+	//queue node, one per operation
+	struct command
+	{
+		std::atomic<command*> next;
+		commandkind kind;
+		patient* ptn;
+		staffmember* stm;
+		room* rm;
+		std::function<bool(hospital&)> operation;
+		//either the promise or done receives the result
+		std::promise<bool> result;
+		std::function<void(bool)> done;
+	};
+
+	hospital* hosp;
+	std::size_t batchlimit;
+	//producers swap themselves in at head, the applier pops at tail
+	std::atomic<command*> head;
+	command* tail;
+	command stub;
+	std::atomic<uint64_t> appliedcount;
+	std::atomic<uint64_t> batchcount;
+	std::atomic<bool> stopping;
+	std::atomic<bool> sleeping;
+	//set by shutdown, and the producers still between reading it and enqueuing
+	std::atomic<bool> closed;
+	std::atomic<unsigned> entering;
+	std::mutex wakelock;
+	std::condition_variable wake;
+	std::thread applier;
+
+	std::future<bool> push(command* cmd);
+	//enqueues the command unless the queue is closed, returns whether it did
+	bool admit(command* cmd);
+	void wakeApplier();
+	void enqueue(command* cmd);
+	command* pop();
+	bool apply(command* cmd);
+	void run();
+
+};
+
+#endif
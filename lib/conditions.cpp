@@ -0,0 +1,89 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+   condition registry source file
+*/
+
+#include "conditions.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+
+//lets the ID map be searched with a string_view, without a copy
+struct namehash
+{
+	using is_transparent = void;
+	std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>()(str); }
+};
+
+struct conditionregistry
+{
+	std::mutex lock;
+	//ID -> string, a deque keeps the strings in place
+	std::deque<std::string> names{""};
+	std::unordered_map<std::string, uint32_t, namehash, std::equal_to<>> ids{{"", 0}};
+	//ID -> triage severity
+	std::deque<int> severities{0};
+};
+
+//function-local, usable by static objects of other files
+conditionregistry& registry()
+{
+	static conditionregistry* reg = new conditionregistry;
+	return *reg;
+}
+
+}
+
+uint32_t conditionId(std::string_view conditionstr)
+{
+	conditionregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	auto found = reg.ids.find(conditionstr);
+	if(found != reg.ids.end()) return found -> second;
+	//first use of this condition, issue the next ID
+	uint32_t id = reg.names.size();
+	reg.names.emplace_back(conditionstr);
+	reg.severities.push_back(0);
+	reg.ids.emplace(reg.names.back(), id);
+	return id;
+}
+
+const std::string& conditionName(uint32_t id)
+{
+	conditionregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	//strings never move or go away, the reference stays valid
+	if(id >= reg.names.size()) return reg.names[0];
+	return reg.names[id];
+}
+
+uint32_t conditionCount()
+{
+	conditionregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	return reg.names.size();
+}
+
+bool setConditionSeverity(std::string_view conditionstr, int severity)
+{
+	//the healthy condition always stays at 0
+	if(severity < 0 || severity > max_severity || conditionstr == "") return false;
+	uint32_t id = conditionId(conditionstr);
+	conditionregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	reg.severities[id] = severity;
+	return true;
+}
+
+int conditionSeverity(std::string_view conditionstr)
+{
+	uint32_t id = conditionId(conditionstr);
+	conditionregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	return reg.severities[id];
+}
@@ -0,0 +1,51 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+   condition registry header file
+*/
+
+#ifndef CONDITIONS_H
+#define CONDITIONS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+Process-wide registry giving every distinct condition
+string a small integer ID, so data derived from patients
+can store and compare conditions as numbers. ID 0 is
+always the empty condition, i.e. a healthy patient.
+IDs are never reused or removed.
+*/
+
+/*
+Returns the ID of a condition, registering it on
+first use. Safe to call from several threads.
+*/
+uint32_t conditionId(std::string_view conditionstr);
+/*
+Returns the condition string of an ID, or an empty
+string for IDs which were never issued. The reference
+stays valid for the lifetime of the program.
+*/
+const std::string& conditionName(uint32_t id);
+/*
+Returns the number of IDs issued so far,
+including ID 0 of the healthy condition.
+*/
+uint32_t conditionCount();
+/*
+Sets the triage severity of a condition, from 0 (not
+urgent) to max_severity. Patients given the condition
+with patient::setCondition take this severity. All
+conditions start at 0.
+*/
+const int max_severity = 5;
+bool setConditionSeverity(std::string_view conditionstr, int severity);
+/*
+Returns the triage severity of a condition.
+*/
+int conditionSeverity(std::string_view conditionstr);
+
+#endif
@@ -0,0 +1,146 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+         dedup source file
+*/
+
+#include "dedup.h"
+#include "objects.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace
+{
+
+constexpr unsigned partition_bits = 6;
+constexpr std::size_t partition_count = std::size_t(1) << partition_bits;
+
+//one patient in the join, 24 bytes so millions sort quickly
+struct record
+{
+	//56 bit name hash above the 8 bit age
+	uint64_t key;
+	const patient* ptn;
+	uint32_t hospital;
+	//handle index, orders the patients of one hospital
+	uint32_t slot;
+};
+
+uint64_t recordKey(const patient& ptn, std::string& buffer)
+{
+	normalisedName(ptn.getName(), ptn.getSurname(), buffer);
+	uint64_t hash = remix(std::hash<std::string_view>()(buffer));
+	return (hash & ~uint64_t(0xFF)) | uint8_t(ptn.getAge());
+}
+
+bool recordBefore(const record& a, const record& b)
+{
+	if(a.key != b.key) return a.key < b.key;
+	if(a.hospital != b.hospital) return a.hospital < b.hospital;
+	return a.slot < b.slot;
+}
+
+//runs work(0) to work(count - 1) on threads of their own, work(0) on the caller's
+void parallelFor(unsigned count, const std::function<void(unsigned)>& work)
+{
+	std::vector<std::thread> workers;
+	for(unsigned t = 1; t < count; t++) workers.emplace_back(work, t);
+	work(0);
+	for(std::thread& worker : workers) worker.join();
+}
+
+//pairs the records of one sorted partition
+void joinPartition(const std::vector<record>& recs, int tolerance, std::vector<duplicatepair>& found)
+{
+	std::string firstname, secondname;
+	for(std::size_t i = 0; i < recs.size(); i++)
+	{
+		uint64_t name = recs[i].key >> 8;
+		int age = recs[i].key & 0xFF;
+		bool normalised = false;
+		//equal names follow in order of age, so stop at the first too old
+		for(std::size_t j = i + 1; j < recs.size() && recs[j].key >> 8 == name; j++)
+		{
+			if(int(recs[j].key & 0xFF) - age > tolerance) break;
+			if(recs[j].hospital == recs[i].hospital) continue;
+			//equal hashes of different names are rare, but possible
+			if(!normalised) normalisedName(recs[i].ptn -> getName(), recs[i].ptn -> getSurname(), firstname);
+			normalised = true;
+			normalisedName(recs[j].ptn -> getName(), recs[j].ptn -> getSurname(), secondname);
+			if(firstname != secondname) continue;
+			const record& a = recs[i].hospital < recs[j].hospital ? recs[i] : recs[j];
+			const record& b = &a == &recs[i] ? recs[j] : recs[i];
+			found.push_back({a.ptn -> getHandle(), b.ptn -> getHandle(), a.hospital, b.hospital});
+		}
+	}
+}
+
+}
+
+void normalisedName(std::string_view namestr, std::string_view surnamestr, std::string& normalised)
+{
+	normalised.clear();
+	auto append = [&normalised](std::string_view part)
+	{
+		//plain ASCII tests, the locale aware ones are slower and not needed
+		for(char c : part)
+		{
+			unsigned char ch = c;
+			if(ch >= 'A' && ch <= 'Z') normalised.push_back(c - 'A' + 'a');
+			else if((ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch >= 128) normalised.push_back(c);
+		}
+	};
+	append(namestr);
+	//keeps "Ann Abel" apart from "Anna Bel"
+	normalised.push_back(' ');
+	append(surnamestr);
+}
+
+std::vector<duplicatepair> findDuplicates(const std::vector<const hospital*>& hospitals, const dedupconfig& config)
+{
+	unsigned threads = config.threads != 0 ? config.threads : std::thread::hardware_concurrency();
+	threads = std::clamp<unsigned>(threads, 1, partition_count);
+	//split the hospitals into runs of about the same number of patients
+	std::vector<std::size_t> before(hospitals.size() + 1, 0);
+	for(std::size_t h = 0; h < hospitals.size(); h++)
+		before[h + 1] = before[h] + hospitals[h] -> getPatientList().size();
+	std::vector<std::size_t> firstof(threads + 1, hospitals.size());
+	for(unsigned t = 0; t < threads; t++)
+		firstof[t] = std::lower_bound(before.begin(), before.end() - 1, before.back() * t / threads) - before.begin();
+
+	//records of every thread, by partition
+	std::vector<std::vector<std::vector<record>>> parts(threads, std::vector<std::vector<record>>(partition_count));
+	parallelFor(threads, [&](unsigned t)
+	{
+		std::string buffer;
+		for(std::size_t h = firstof[t]; h < firstof[t + 1]; h++)
+			for(const patient* ptn : hospitals[h] -> getPatientList())
+			{
+				record rec{recordKey(*ptn, buffer), ptn, uint32_t(h), ptn -> getHandle().index};
+				parts[t][rec.key >> (64 - partition_bits)].push_back(rec);
+			}
+	});
+
+	//pairs of every partition, joined in turns by the threads
+	std::vector<std::vector<duplicatepair>> found(partition_count);
+	parallelFor(threads, [&](unsigned t)
+	{
+		std::vector<record> recs;
+		for(std::size_t p = t; p < partition_count; p += threads)
+		{
+			recs.clear();
+			for(unsigned from = 0; from < threads; from++)
+			{
+				recs.insert(recs.end(), parts[from][p].begin(), parts[from][p].end());
+				std::vector<record>().swap(parts[from][p]);
+			}
+			std::sort(recs.begin(), recs.end(), recordBefore);
+			joinPartition(recs, config.agetolerance, found[p]);
+		}
+	});
+
+	std::vector<duplicatepair> pairs;
+	for(const std::vector<duplicatepair>& part : found) pairs.insert(pairs.end(), part.begin(), part.end());
+	return pairs;
+}
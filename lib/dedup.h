@@ -0,0 +1,75 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+         dedup header file
+*/
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "handles.h"
+
+class hospital;
+
+/*
+Settings of a duplicate search.
+*/
+struct dedupconfig
+{
+	//largest age difference of two records of one person,
+	//0 requires equal ages
+	int agetolerance = 0;
+	//worker threads, 0 uses one per CPU
+	unsigned threads = 0;
+};
+
+/*
+Two patients of different hospitals that are likely one
+person: equal names after normalisation (see
+normalisedName) and ages within the tolerance. The
+hospitals are given as positions in the searched list.
+*/
+struct duplicatepair
+{
+	entityhandle first;
+	entityhandle second;
+	uint32_t firsthospital;
+	uint32_t secondhospital;
+};
+
+/*
+Writes the name and surname of a person in the form the
+duplicate search compares: lower case, with everything
+but letters and digits dropped, so "O'Brien" and
+"o brien" are the same. Bytes of non-ASCII characters
+are kept as they are.
+*/
+void normalisedName(std::string_view namestr, std::string_view surnamestr, std::string& normalised);
+
+/*
+Finds the patients registered in more than one of the
+given hospitals, as a partitioned parallel sort-merge
+join of all their patients with themselves:
+
+- every thread turns the patients of a share of the
+  hospitals into records of a 56 bit hash of the
+  normalised name and the age, split into partitions by
+  the top bits of the hash
+- every thread then sorts a share of the partitions by
+  (hash, age, hospital) and walks each one, pairing the
+  records of equal hashes and close enough ages, and
+  confirming the names to rule out hash collisions
+
+Each pair is reported once, first hospital first, in an
+order that does not depend on the number of threads. A
+person in k hospitals gives k(k-1)/2 pairs.
+
+The hospitals must not change during the search.
+*/
+std::vector<duplicatepair> findDuplicates(const std::vector<const hospital*>& hospitals, const dedupconfig& config = dedupconfig());
+
+#endif
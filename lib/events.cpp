@@ -0,0 +1,190 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        events source file
+*/
+
+#include "events.h"
+
+const char* eventName(eventkind kind)
+{
+	switch(kind)
+	{
+		case event_patient_registered: return "patient_registered";
+		case event_patient_discharged: return "patient_discharged";
+		case event_patient_roomed: return "patient_roomed";
+		case event_patient_unroomed: return "patient_unroomed";
+		case event_staff_employed: return "staff_employed";
+		case event_staff_dismissed: return "staff_dismissed";
+		case event_staff_assigned: return "staff_assigned";
+		case event_staff_unassigned: return "staff_unassigned";
+		case event_room_added: return "room_added";
+		case event_room_removed: return "room_removed";
+		case event_patient_waitlisted: return "patient_waitlisted";
+		case event_patient_admitted: return "patient_admitted";
+		default: return "none";
+	}
+}
+
+std::ostream& operator<<(std::ostream& str, const hospitalevent& evt)
+{
+	str << "EVENT " << evt.sequence << ": " << eventName(evt.kind);
+	str << " subject " << evt.subject.index << "." << evt.subject.generation;
+	if(!evt.target.isNull())
+	str << " target " << evt.target.index << "." << evt.target.generation;
+	return str;
+}
+
+eventfeed::eventfeed(std::size_t capacity, overflowpolicy policy)
+{
+	//round up to a power of two, so a slot is found with a mask
+	std::size_t size = 2;
+	while(size < capacity) size <<= 1;
+	slots = std::vector<feedslot>(size);
+	for(feedslot& s : slots) s.seq.store(0, std::memory_order_relaxed);
+	mask = size - 1;
+	overflow = policy;
+	head.store(0, std::memory_order_relaxed);
+	rejects.store(0, std::memory_order_relaxed);
+	for(std::atomic<uint64_t>& c : cursors) c.store(no_cursor, std::memory_order_relaxed);
+}
+
+bool eventfeed::publish(eventkind kind, entityhandle hosp, entityhandle subject, entityhandle target)
+{
+	uint64_t pos = head.load(std::memory_order_relaxed);
+	if(overflow == reject_newest)
+	{
+		//claim a position only if no subscriber still needs its slot
+		do
+		{
+			uint64_t slowest = slowestCursor();
+			if(slowest != no_cursor && pos - slowest > mask)
+			{
+				rejects.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+		while(!head.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel));
+	}
+	else pos = head.fetch_add(1, std::memory_order_acq_rel);
+	//seqlock write: odd while the words change
+	feedslot& s = slots[pos & mask];
+	s.seq.store(2 * pos + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	s.words[0].store(kind, std::memory_order_relaxed);
+	s.words[1].store(hosp.pack(), std::memory_order_relaxed);
+	s.words[2].store(subject.pack(), std::memory_order_relaxed);
+	s.words[3].store(target.pack(), std::memory_order_relaxed);
+	s.seq.store(2 * pos + 2, std::memory_order_release);
+	return true;
+}
+
+uint64_t eventfeed::published() const
+{
+	return head.load(std::memory_order_acquire);
+}
+
+uint64_t eventfeed::rejected() const
+{
+	return rejects.load(std::memory_order_relaxed);
+}
+
+std::size_t eventfeed::capacity() const
+{
+	return slots.size();
+}
+
+eventfeed::overflowpolicy eventfeed::policy() const
+{
+	return overflow;
+}
+
+uint64_t eventfeed::slowestCursor() const
+{
+	uint64_t slowest = no_cursor;
+	for(const std::atomic<uint64_t>& c : cursors)
+	{
+		uint64_t pos = c.load(std::memory_order_acquire);
+		if(pos < slowest) slowest = pos;
+	}
+	return slowest;
+}
+
+eventsubscriber::eventsubscriber(eventfeed& fd)
+{
+	feed = &fd;
+	cursor = fd.published();
+	lost = 0;
+	//take the first free cursor of the feed
+	for(slot = 0; slot < eventfeed::max_subscribers; slot++)
+	{
+		uint64_t unused = eventfeed::no_cursor;
+		if(fd.cursors[slot].compare_exchange_strong(unused, cursor, std::memory_order_acq_rel)) break;
+	}
+}
+
+eventsubscriber::~eventsubscriber()
+{
+	if(isValid()) feed -> cursors[slot].store(eventfeed::no_cursor, std::memory_order_release);
+}
+
+bool eventsubscriber::isValid() const
+{
+	return slot < eventfeed::max_subscribers;
+}
+
+bool eventsubscriber::poll(hospitalevent& evt)
+{
+	if(!isValid()) return false;
+	while(true)
+	{
+		const eventfeed::feedslot& s = feed -> slots[cursor & feed -> mask];
+		uint64_t expected = 2 * cursor + 2;
+		uint64_t before = s.seq.load(std::memory_order_acquire);
+		//not written yet
+		if(before < expected) return false;
+		if(before == expected)
+		{
+			uint64_t words[4];
+			for(int i = 0; i < 4; i++) words[i] = s.words[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			//the event is valid only if the slot was not rewritten meanwhile
+			if(s.seq.load(std::memory_order_relaxed) == expected)
+			{
+				evt.sequence = cursor;
+				evt.kind = eventkind(words[0]);
+				evt.hospital = entityhandle::unpack(words[1]);
+				evt.subject = entityhandle::unpack(words[2]);
+				evt.target = entityhandle::unpack(words[3]);
+				cursor++;
+				feed -> cursors[slot].store(cursor, std::memory_order_release);
+				return true;
+			}
+		}
+		//the producer lapped this subscriber, skip to the oldest event left
+		uint64_t newest = feed -> published();
+		uint64_t oldest = newest > feed -> capacity() ? newest - feed -> capacity() : 0;
+		if(oldest <= cursor) oldest = cursor + 1;
+		lost += oldest - cursor;
+		cursor = oldest;
+		feed -> cursors[slot].store(cursor, std::memory_order_release);
+	}
+}
+
+std::size_t eventsubscriber::pollBatch(hospitalevent* out, std::size_t max)
+{
+	std::size_t count = 0;
+	while(count < max && poll(out[count])) count++;
+	return count;
+}
+
+uint64_t eventsubscriber::dropped() const
+{
+	return lost;
+}
+
+uint64_t eventsubscriber::pending() const
+{
+	if(!isValid()) return 0;
+	return feed -> published() - cursor;
+}
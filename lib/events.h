@@ -0,0 +1,189 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        events header file
+*/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "handles.h"
+
+/*
+Kinds of hospital mutations reported by a feed.
+A transfer between rooms shows up as an unroomed
+event followed by a roomed one. A patient taken off a
+waitlist into a freed bed shows up as a single admitted
+event in place of the roomed one, and a patient put on a
+waitlist as a waitlisted event (targeting the room, or
+null when waiting for any bed of its condition).
+*/
+enum eventkind
+{
+	event_none,
+	event_patient_registered,
+	event_patient_discharged,
+	event_patient_roomed,
+	event_patient_unroomed,
+	event_staff_employed,
+	event_staff_dismissed,
+	event_staff_assigned,
+	event_staff_unassigned,
+	event_room_added,
+	event_room_removed,
+	event_patient_waitlisted,
+	event_patient_admitted
+};
+
+/*
+A single mutation. Subject is the patient, staffmember
+or room that changed, target is the room it was linked
+to or unlinked from (null for hospital level events).
+Sequence numbers start at 0 and grow by one per event
+published to the feed.
+*/
+struct hospitalevent
+{
+	uint64_t sequence;
+	eventkind kind;
+	entityhandle hospital;
+	entityhandle subject;
+	entityhandle target;
+};
+
+/*
+Returns a printable name of an event kind.
+*/
+const char* eventName(eventkind kind);
+/*
+Outputs the sequence, kind and handles of an event.
+*/
+std::ostream& operator<<(std::ostream& str, const hospitalevent& evt);
+
+/*
+A bounded broadcast ring of hospital events. Hospitals
+publish into it (see hospital::attachFeed), subscribers
+read every event at their own pace through their own
+cursor, without locks on either side.
+
+When the slowest subscriber is a full ring behind, the
+policy decides what gives way:
+- overwrite_oldest: the event is published and lagging
+  subscribers lose the oldest ones, which they see in
+  eventsubscriber::dropped()
+- reject_newest: the event is not published and is
+  counted in rejected(), so no subscriber loses data
+
+Publishing is lock-free but expects one producer at a
+time, same as the hospitals feeding it.
+*/
+class eventfeed
+{
+
+friend class eventsubscriber;
+
+public:
+	enum overflowpolicy
+	{
+		overwrite_oldest,
+		reject_newest
+	};
+	static constexpr unsigned max_subscribers = 16;
+
+	/*
+	Creates a feed holding capacity events, rounded up
+	to a power of two (at least 2).
+	*/
+	eventfeed(std::size_t capacity = 1 << 16, overflowpolicy policy = overwrite_oldest);
+	eventfeed(const eventfeed&) = delete;
+	eventfeed& operator=(const eventfeed&) = delete;
+	/*
+	Appends an event. Returns false if the event was
+	rejected by the reject_newest policy.
+	*/
+	bool publish(eventkind kind, entityhandle hosp, entityhandle subject, entityhandle target);
+	/*
+	Returns the number of events published so far.
+	*/
+	uint64_t published() const;
+	/*
+	Returns the number of events rejected so far.
+	*/
+	uint64_t rejected() const;
+	std::size_t capacity() const;
+	overflowpolicy policy() const;
+
+private:
+	//one event; seq is odd while it is written,
+	//2*(sequence+1) once the event is readable
+	struct alignas(64) feedslot
+	{
+		std::atomic<uint64_t> seq;
+		std::atomic<uint64_t> words[4];
+	};
+
+	std::vector<feedslot> slots;
+	uint64_t mask;
+	overflowpolicy overflow;
+	std::atomic<uint64_t> head;
+	std::atomic<uint64_t> rejects;
+	//next sequence read by each subscriber, no_cursor if unused
+	std::atomic<uint64_t> cursors[max_subscribers];
+
+	static constexpr uint64_t no_cursor = UINT64_MAX;
+	uint64_t slowestCursor() const;
+
+};
+
+/*
+A reading position in a feed. Starts at the newest
+event, so it only sees events published after it was
+created. Must not outlive its feed. Each subscriber is
+meant to be polled by a single thread.
+*/
+class eventsubscriber
+{
+
+public:
+	/*
+	Registers a cursor in the feed. The subscriber is
+	invalid if the feed already has max_subscribers.
+	*/
+	eventsubscriber(eventfeed& fd);
+	~eventsubscriber();
+	eventsubscriber(const eventsubscriber&) = delete;
+	eventsubscriber& operator=(const eventsubscriber&) = delete;
+	bool isValid() const;
+	/*
+	Reads the next event into evt. Returns false if
+	there is no new event yet.
+	*/
+	bool poll(hospitalevent& evt);
+	/*
+	Reads up to max events into out, returns how
+	many were read.
+	*/
+	std::size_t pollBatch(hospitalevent* out, std::size_t max);
+	/*
+	Returns the number of events that were overwritten
+	before this subscriber could read them.
+	*/
+	uint64_t dropped() const;
+	/*
+	Returns the number of published events not read yet.
+	*/
+	uint64_t pending() const;
+
+private:
+	eventfeed* feed;
+	unsigned slot;
+	uint64_t cursor;
+	uint64_t lost;
+
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        fuzzy search source file
+*/
+
+#include "fuzzy.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+int editDistance(std::string_view a, std::string_view b, int limit)
+{
+	int alen = a.size(), blen = b.size();
+	if(std::abs(alen - blen) > limit) return limit + 1;
+	//two rows of the edit matrix, on the stack for names of usual length
+	int buffer[2][64];
+	std::vector<int> heaprows;
+	int* previous = buffer[0];
+	int* current = buffer[1];
+	if(blen >= 64)
+	{
+		heaprows.resize(2 * (blen + 1));
+		previous = heaprows.data();
+		current = previous + blen + 1;
+	}
+	for(int j = 0; j <= blen; j++) previous[j] = j;
+	for(int i = 1; i <= alen; i++)
+	{
+		current[0] = i;
+		int rowmin = i;
+		for(int j = 1; j <= blen; j++)
+		{
+			int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+			current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+			rowmin = std::min(rowmin, current[j]);
+		}
+		//every later row is at least as far
+		if(rowmin > limit) return limit + 1;
+		std::swap(previous, current);
+	}
+	return std::min(previous[blen], limit + 1);
+}
+
+trigramindex::trigramindex(std::pmr::memory_resource* resource) : records(resource), slotof(resource), postings(resource), scratch(resource), shared(resource), touched(resource)
+{
+	dead = 0;
+}
+
+bool trigramindex::insert(std::string_view key, uint64_t value)
+{
+	if(slotof.count(value) != 0) return false;
+	uint32_t slot = records.size();
+	//the key is copied into the resource of the index
+	records.push_back({std::pmr::string(records.get_allocator()), value, true});
+	normalise(key, records.back().key);
+	slotof[value] = slot;
+	trigrams(records.back().key, scratch);
+	for(uint32_t gram : scratch) postings[gram].push_back(slot);
+	return true;
+}
+
+bool trigramindex::erase(uint64_t value)
+{
+	auto found = slotof.find(value);
+	if(found == slotof.end()) return false;
+	records[found -> second].live = false;
+	slotof.erase(found);
+	dead++;
+	//postings of erased records are dropped in bulk
+	if(dead > compact_after && dead > slotof.size()) compact();
+	return true;
+}
+
+std::vector<fuzzymatch> trigramindex::search(std::string_view query, std::size_t count, int maxdistance) const
+{
+	std::vector<fuzzymatch> found;
+	if(count == 0 || maxdistance < 0) return found;
+	std::pmr::string key;
+	normalise(query, key);
+	std::pmr::vector<uint32_t> grams;
+	trigrams(key, grams);
+	//an edit changes at most three trigrams of the query, and the
+	//counters saturate, so a long query needs at most their maximum
+	std::size_t needed = std::max(1, int(grams.size()) - 3 * maxdistance);
+	needed = std::min<std::size_t>(needed, UINT8_MAX);
+	//trigrams every record shares with the query, saturating
+	if(shared.size() < records.size()) shared.resize(records.size(), 0);
+	std::vector<uint32_t> candidates;
+	for(uint32_t gram : grams)
+	{
+		auto list = postings.find(gram);
+		if(list == postings.end()) continue;
+		for(uint32_t slot : list -> second)
+		{
+			if(shared[slot] == UINT8_MAX) continue;
+			if(shared[slot] == 0) touched.push_back(slot);
+			if(++shared[slot] == needed) candidates.push_back(slot);
+		}
+	}
+	//verify the candidates, ranking ties by trigram overlap
+	struct ranked
+	{
+		uint32_t slot;
+		int distance;
+	};
+	std::vector<ranked> verified;
+	for(uint32_t slot : candidates)
+	{
+		if(!records[slot].live) continue;
+		int distance = editDistance(key, records[slot].key, maxdistance);
+		if(distance <= maxdistance) verified.push_back({slot, distance});
+	}
+	auto closer = [this](const ranked& a, const ranked& b)
+	{
+		if(a.distance != b.distance) return a.distance < b.distance;
+		if(shared[a.slot] != shared[b.slot]) return shared[a.slot] > shared[b.slot];
+		return a.slot < b.slot;
+	};
+	std::size_t kept = std::min(count, verified.size());
+	std::partial_sort(verified.begin(), verified.begin() + kept, verified.end(), closer);
+	for(std::size_t i = 0; i < kept; i++) found.push_back({records[verified[i].slot].value, verified[i].distance});
+	for(uint32_t slot : touched) shared[slot] = 0;
+	touched.clear();
+	return found;
+}
+
+std::size_t trigramindex::size() const
+{
+	return slotof.size();
+}
+
+void trigramindex::reserve(std::size_t count)
+{
+	records.reserve(count + std::max(compact_after, count) + 1);
+	slotof.reserve(count);
+}
+
+void trigramindex::normalise(std::string_view key, std::pmr::string& normalised)
+{
+	normalised.assign(key);
+	for(char& c : normalised) c = std::tolower((unsigned char)c);
+}
+
+void trigramindex::trigrams(std::string_view normalised, std::pmr::vector<uint32_t>& grams)
+{
+	grams.clear();
+	//the key is padded with two spaces in front and one behind, so the
+	//first letters and the last one get trigrams of their own
+	std::size_t padded = normalised.size() + 3;
+	auto at = [&normalised](std::size_t i) -> uint32_t
+	{
+		return i < 2 || i - 2 >= normalised.size() ? ' ' : (unsigned char)normalised[i - 2];
+	};
+	for(std::size_t i = 0; i + 3 <= padded; i++) grams.push_back((at(i) << 16) | (at(i + 1) << 8) | at(i + 2));
+	std::sort(grams.begin(), grams.end());
+	grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+void trigramindex::compact()
+{
+	//moves the live records down and refills the posting lists, so the
+	//index keeps the memory it has instead of building everything anew
+	uint32_t kept = 0;
+	for(uint32_t slot = 0; slot < records.size(); slot++)
+	{
+		if(!records[slot].live) continue;
+		if(slot != kept)
+		{
+			records[kept] = std::move(records[slot]);
+			slotof[records[kept].value] = kept;
+		}
+		kept++;
+	}
+	records.erase(records.begin() + kept, records.end());
+	dead = 0;
+	for(auto& list : postings) list.second.clear();
+	for(uint32_t slot = 0; slot < records.size(); slot++)
+	{
+		trigrams(records[slot].key, scratch);
+		for(uint32_t gram : scratch) postings[gram].push_back(slot);
+	}
+	//trigrams only erased names had
+	std::erase_if(postings, [](const auto& list) { return list.second.empty(); });
+}
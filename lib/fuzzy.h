@@ -0,0 +1,119 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        fuzzy search header file
+*/
+
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Returns the Levenshtein distance between two strings,
+or limit + 1 as soon as it is known to exceed limit.
+*/
+int editDistance(std::string_view a, std::string_view b, int limit);
+
+/*
+A record found by trigramindex::search.
+*/
+struct fuzzymatch
+{
+	uint64_t value;
+	int distance;
+};
+
+/*
+Approximate string index. Every key is lowercased, padded
+and cut into overlapping three letter pieces (trigrams),
+each of which lists the records containing it. A search
+counts the trigrams every record shares with the query,
+skips records sharing too few to be within the allowed
+edit distance (an edit changes at most three trigrams),
+and verifies the rest with editDistance, so only a small
+part of the keys is ever compared.
+
+Every hospital keeps one over patient names and one over
+staff names (see hospital::findPatients).
+*/
+class trigramindex
+{
+
+public:
+	/*
+	Starts empty, taking memory from the given resource.
+	*/
+	trigramindex(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/*
+	Adds a key with a value identifying its record.
+	Returns false if the value is indexed already.
+	*/
+	bool insert(std::string_view key, uint64_t value);
+	/*
+	Removes the record of a value, returns false if
+	it is not indexed.
+	*/
+	bool erase(uint64_t value);
+	/*
+	Returns up to count records within maxdistance edits
+	of the query (ignoring case), closest first. Ties go
+	to the record sharing more trigrams, then to the
+	earlier inserted one. Searches share a buffer of the
+	index, so they must not run concurrently.
+	*/
+	std::vector<fuzzymatch> search(std::string_view query, std::size_t count, int maxdistance) const;
+	/*
+	Returns the number of indexed records.
+	*/
+	std::size_t size() const;
+	/*
+	Makes room for count records and the erased ones kept
+	with them (see compact_after), so the record list
+	never grows while the index holds up to count.
+	*/
+	void reserve(std::size_t count);
+	/*
+	Erased records are dropped in bulk once there are more
+	than this many and more than the live ones, so at most
+	max(compact_after, size()) + 1 are kept.
+	*/
+	static constexpr std::size_t compact_after = 1024;
+
+private:
+	struct record
+	{
+		//lowercased key
+		std::pmr::string key;
+		uint64_t value;
+		bool live;
+	};
+	//records in insertion order, erased ones stay until compact()
+	std::pmr::vector<record> records;
+	std::size_t dead;
+	//value -> position in records
+	std::pmr::unordered_map<uint64_t, uint32_t> slotof;
+	//trigram -> positions of the records containing it
+	std::pmr::unordered_map<uint32_t, std::pmr::vector<uint32_t>> postings;
+
+	//trigrams of the last inserted key, kept to reuse the buffer
+	std::pmr::vector<uint32_t> scratch;
+	//trigrams each record shares with the last query, and the
+	//records it touched, zeroed again after every search
+	mutable std::pmr::vector<uint8_t> shared;
+	mutable std::pmr::vector<uint32_t> touched;
+
+	static void normalise(std::string_view key, std::pmr::string& normalised);
+	//sorted distinct trigrams of a normalised key
+	static void trigrams(std::string_view normalised, std::pmr::vector<uint32_t>& grams);
+	//drops erased records and renumbers the postings, in place
+	void compact();
+
+};
+
+#endif
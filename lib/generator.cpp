@@ -0,0 +1,207 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+   population generator source file
+*/
+
+#include "generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+
+const char* const first_names[] =
+{
+	"James", "Mary", "John", "Patricia", "Robert", "Jennifer", "Michael", "Linda",
+	"William", "Elizabeth", "David", "Barbara", "Richard", "Susan", "Joseph", "Jessica",
+	"Thomas", "Sarah", "Charles", "Karen", "Daniel", "Nancy", "Matthew", "Lisa",
+	"Anthony", "Betty", "Mark", "Margaret", "Donald", "Sandra", "Steven", "Ashley",
+	"Paul", "Kimberly", "Andrew", "Emily", "Joshua", "Donna", "Kenneth", "Michelle",
+	"Kevin", "Dorothy", "Brian", "Carol", "George", "Amanda", "Edward", "Melissa",
+	"Artur", "Julia", "Jan", "Anna", "Piotr", "Maria", "Jason", "Jenny",
+	"Sylvia", "Dylan", "Alexander", "Helen"
+};
+
+const char* const surnames[] =
+{
+	"Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis",
+	"Rodriguez", "Martinez", "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas",
+	"Taylor", "Moore", "Jackson", "Martin", "Lee", "Perez", "Thompson", "White",
+	"Harris", "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson", "Walker", "Young",
+	"Allen", "King", "Wright", "Scott", "Torres", "Nguyen", "Hill", "Flores",
+	"Green", "Adams", "Nelson", "Baker", "Hall", "Rivera", "Campbell", "Mitchell",
+	"Carter", "Roberts", "Nowak", "Kowalski", "Wisniewski", "Wojcik", "Kaminski", "Lewandowski",
+	"Zielinski", "Szymanski", "Blair", "Bird", "Portman", "MacDonald", "Stout", "Mackintosh",
+	"Ross", "Hyde", "Jeckyll", "Jaw", "Sebastian", "Murphy", "Cook", "Rogers",
+	"Morgan", "Peterson", "Cooper", "Reed", "Bailey", "Bell", "Gomez", "Kelly"
+};
+
+const char* const room_kinds[] =
+{
+	"surgical", "observation", "recovery ward", "intensive care", "maternity",
+	"pediatric", "cardiology", "neurology", "orthopedic", "general ward"
+};
+
+const std::size_t first_count = sizeof(first_names) / sizeof(first_names[0]);
+const std::size_t surname_count = sizeof(surnames) / sizeof(surnames[0]);
+const std::size_t kind_count = sizeof(room_kinds) / sizeof(room_kinds[0]);
+
+/*
+Maps a number to a unique (name, surname) pair. Small
+numbers give plain pool names, larger ones double-barrelled
+surnames and only past that a numeric suffix is added.
+*/
+std::pair<std::string, std::string> uniqueName(uint64_t number, uint64_t rotation)
+{
+	std::string name = first_names[(number + rotation) % first_count];
+	number /= first_count;
+	std::string surname = surnames[(number + rotation) % surname_count];
+	number /= surname_count;
+	if(number > 0)
+	{
+		surname += "-";
+		surname += surnames[(number + rotation) % surname_count];
+		number /= surname_count;
+	}
+	if(number > 0) surname += " " + std::to_string(number + 1);
+	return {name, surname};
+}
+
+}
+
+populationrandom::populationrandom(uint64_t seed)
+{
+	state = seed;
+}
+
+uint64_t populationrandom::next()
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+uint64_t populationrandom::below(uint64_t bound)
+{
+	return bound != 0 ? next() % bound : 0;
+}
+
+double populationrandom::unit()
+{
+	//53 random bits give every representable step of [0;1)
+	return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+syntheticpopulation::syntheticpopulation(const populationconfig& config)
+	: collisions(0), hosp(config.hospitalname)
+{
+	populationrandom rng(config.seed);
+	uint64_t rotation = rng.next();
+
+	//rooms get a kind and a running number
+	for(std::size_t i = 0; i < config.rooms; i++)
+		rooms.emplace_back(std::string(room_kinds[(i + rotation) % kind_count]) + " " + std::to_string(i + 1));
+
+	//staff names come from a separate part of the name space
+	std::size_t staffnumber = 0;
+	for(const auto& profession : config.staff)
+	{
+		for(std::size_t i = 0; i < profession.second; i++)
+		{
+			auto nm = uniqueName(staffnumber++, rotation + 7);
+			staff.emplace_back(nm.first, nm.second, 25 + int(rng.below(40)));
+			staff.back().setType(profession.first);
+		}
+	}
+
+	//cumulative condition weights for sampling
+	std::vector<double> weights;
+	double total = 0;
+	for(const auto& cond : config.conditions)
+	{
+		total += cond.second;
+		weights.push_back(total);
+	}
+
+	//names are handed out in a shuffled but collision free order,
+	//stepping through [0;patients) with a stride coprime to it
+	uint64_t span = std::max<uint64_t>(config.patients, 1);
+	uint64_t stride = rng.below(span) | 1;
+	while(std::gcd(stride, span) != 1) stride += 2;
+	for(std::size_t i = 0; i < config.patients; i++)
+	{
+		std::pair<std::string, std::string> nm;
+		if(i > 0 && rng.unit() < config.collisionrate)
+		{
+			//reuse the full name of an earlier patient
+			const patient& earlier = patients[rng.below(i)];
+			nm = {std::string(earlier.getName()), std::string(earlier.getSurname())};
+		}
+		else nm = uniqueName((i * stride) % span, rotation);
+		//approximate bell curve as the sum of four uniforms
+		double bell = (rng.unit() + rng.unit() + rng.unit() + rng.unit() - 2.0) * std::sqrt(3.0);
+		int age = int(std::lround(config.agemean + config.agespread * bell));
+		age = std::min(std::max(age, 0), config.agemax);
+		patients.emplace_back(nm.first, nm.second, age);
+		if(total > 0)
+		{
+			double pick = rng.unit() * total;
+			std::size_t c = std::upper_bound(weights.begin(), weights.end(), pick) - weights.begin();
+			if(c >= weights.size()) c = weights.size() - 1;
+			//empty condition keeps the patient healthy
+			if(config.conditions[c].first != "") patients.back().setCondition<trustedinput>(config.conditions[c].first);
+		}
+	}
+
+	if(!config.link) return;
+
+	for(room& rm : rooms) hosp.addRoom(rm);
+	for(staffmember& stm : staff) hosp.employStaff(stm);
+	//the first rooms get caretakers, one staff member each
+	std::size_t staffed = std::min(std::size_t(config.rooms * config.staffedshare), staff.size());
+	for(std::size_t i = 0; i < staffed; i++) rooms[i].linkStaff(staff[i]);
+
+	std::size_t next_room = 0;
+	for(patient& ptn : patients)
+	{
+		if(!hosp.registerPatient(ptn))
+		{
+			collisions++;
+			continue;
+		}
+		if(!rooms.empty() && rng.unit() < config.roomedshare)
+		{
+			rooms[next_room].addPatient(ptn);
+			next_room = (next_room + 1) % rooms.size();
+		}
+	}
+}
+
+hospital& syntheticpopulation::getHospital()
+{
+	return hosp;
+}
+
+std::deque<patient>& syntheticpopulation::getPatients()
+{
+	return patients;
+}
+
+std::deque<staffmember>& syntheticpopulation::getStaff()
+{
+	return staff;
+}
+
+std::deque<room>& syntheticpopulation::getRooms()
+{
+	return rooms;
+}
+
+std::size_t syntheticpopulation::getCollisions() const
+{
+	return collisions;
+}
@@ -0,0 +1,125 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+   population generator header file
+*/
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include "objects.h"
+
+/*
+Settings of a synthetic hospital. Defaults describe
+a small general hospital; every field can be changed
+before passing the config to syntheticpopulation.
+*/
+struct populationconfig
+{
+	//same seed and settings always give the same hospital
+	uint64_t seed = 2021;
+	std::string hospitalname = "St. Synthetic's general";
+	std::size_t rooms = 20;
+	//profession and number of staff members with it
+	std::vector<std::pair<std::string, std::size_t>> staff =
+		{{"surgeon", 5}, {"physician", 10}, {"nurse", 40}, {"paramedic", 5}};
+	std::size_t patients = 500;
+	//condition and its relative weight, empty condition means healthy
+	std::vector<std::pair<std::string, double>> conditions =
+		{{"", 10}, {"fracture", 15}, {"pneumonia", 12}, {"influenza", 20},
+		{"hemorrhage", 3}, {"stroke", 4}, {"poisoning", 2}, {"dehydration", 8},
+		{"appendicitis", 6}, {"hyponatremia", 1}};
+	//age is drawn from a bell curve, clamped to [0;agemax]
+	double agemean = 48;
+	double agespread = 22;
+	int agemax = 105;
+	//share of patients reusing the full name of an earlier one
+	//(such duplicates are refused by hospital::registerPatient)
+	double collisionrate = 0.001;
+	//share of registered patients placed in a room
+	double roomedshare = 0.8;
+	//share of rooms with a caretaker linked
+	double staffedshare = 0.9;
+	//when false, entities are only created and not linked
+	bool link = true;
+};
+
+/*
+A deterministic, seedable synthetic hospital.
+Owns every entity it creates and links them only
+through the public hospital/room API, so it exercises
+the same code paths as real use. Entities live in
+deques, which keeps their addresses stable.
+*/
+class syntheticpopulation
+{
+
+public:
+	/*
+	Creates all entities described by the config and,
+	unless config.link is false, employs the staff, adds
+	the rooms, registers the patients and places them in
+	rooms round-robin.
+	*/
+	syntheticpopulation(const populationconfig& config);
+	syntheticpopulation(const syntheticpopulation&) = delete;
+	syntheticpopulation& operator=(const syntheticpopulation&) = delete;
+	/*
+	Returns the generated hospital.
+	*/
+	hospital& getHospital();
+	/*
+	Return every generated entity, linked or not.
+	*/
+	std::deque<patient>& getPatients();
+	std::deque<staffmember>& getStaff();
+	std::deque<room>& getRooms();
+	/*
+	Returns the number of patients refused by
+	registerPatient because of a name collision.
+	*/
+	std::size_t getCollisions() const;
+
+private:
+	std::deque<room> rooms;
+	std::deque<staffmember> staff;
+	std::deque<patient> patients;
+	std::size_t collisions;
+	//declared last so it is destroyed before the entities
+	hospital hosp;
+
+};
+
+/*
+Small deterministic random generator (splitmix64),
+giving the same sequence on every platform.
+*/
+class populationrandom
+{
+
+public:
+	populationrandom(uint64_t seed);
+	/*
+	Returns the next 64 random bits.
+	*/
+	uint64_t next();
+	/*
+	Returns a uniform value in [0;bound).
+	*/
+	uint64_t below(uint64_t bound);
+	/*
+	Returns a uniform value in [0;1).
+	*/
+	double unit();
+
+private:
+	uint64_t state;
+
+};
+
+#endif
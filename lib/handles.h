@@ -0,0 +1,166 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       handle header file
+*/
+
+#ifndef HANDLES_H
+#define HANDLES_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/*
+A compact, stable reference to an entity. The index
+selects a slot of the entity type's handle table and
+the generation tells apart successive owners of that
+slot, so a handle to a destroyed entity is detected
+as stale instead of resolving to its successor.
+Generation 0 is never issued, so a default handle
+is the null handle.
+*/
+struct entityhandle
+{
+	uint32_t index = 0;
+	uint32_t generation = 0;
+
+	/*
+	Checks if the handle was ever issued. A non-null
+	handle may still be stale.
+	*/
+	bool isNull() const { return generation == 0; }
+	/*
+	Packs the handle into 8 bytes for indexes,
+	journals and snapshots.
+	*/
+	uint64_t pack() const { return (uint64_t(generation) << 32) | index; }
+	/*
+	Restores a handle packed with pack().
+	*/
+	static entityhandle unpack(uint64_t packed) { return {uint32_t(packed), uint32_t(packed >> 32)}; }
+
+	bool operator==(const entityhandle& ref) const
+	{ return index == ref.index && generation == ref.generation; }
+	bool operator!=(const entityhandle& ref) const { return !(*this == ref); }
+};
+
+/*
+Slot table mapping handles of one entity type to the
+live objects. Slots are stored in fixed size pages which
+are never moved, so resolve() is lock free and may run
+concurrently with acquire() and release() on other
+threads. Keeping the object alive while it is used is
+still up to the caller.
+*/
+template <class T>
+class handletable
+{
+
+public:
+	handletable() : pagecount(0)
+	{
+		for(auto& page : pages) page.store(nullptr, std::memory_order_relaxed);
+	}
+	~handletable()
+	{
+		for(auto& page : pages) delete[] page.load(std::memory_order_relaxed);
+	}
+	handletable(const handletable&) = delete;
+	handletable& operator=(const handletable&) = delete;
+	/*
+	Assigns a slot to the object and returns its handle.
+	Freed slots are reused with a bumped generation.
+	*/
+	entityhandle acquire(T* object)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		uint32_t index;
+		if(!freeslots.empty())
+		{
+			index = freeslots.back();
+			freeslots.pop_back();
+		}
+		else
+		{
+			index = nextslot++;
+			//slot 0 stays unused so a packed 0 is always null
+			if(index == 0) index = nextslot++;
+			uint32_t page = index >> page_bits;
+			if(page >= max_pages) return entityhandle();
+			if(page >= pagecount.load(std::memory_order_relaxed))
+			{
+				pages[page].store(new slot[page_size], std::memory_order_release);
+				pagecount.store(page + 1, std::memory_order_release);
+			}
+		}
+		slot& s = at(index);
+		uint32_t gen = s.generation.load(std::memory_order_relaxed) + 1;
+		//generation 0 is reserved for the null handle
+		if(gen == 0) gen = 1;
+		s.object.store(object, std::memory_order_relaxed);
+		s.generation.store(gen, std::memory_order_release);
+		return {index, gen};
+	}
+	/*
+	Frees the slot of a handle, making every copy of
+	the handle stale. Stale or null handles are ignored.
+	*/
+	void release(entityhandle handle)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if(resolve(handle) == nullptr) return;
+		slot& s = at(handle.index);
+		s.object.store(nullptr, std::memory_order_relaxed);
+		//bumping the generation makes every copy of the handle stale
+		s.generation.store(handle.generation + 1 != 0 ? handle.generation + 1 : 1, std::memory_order_release);
+		freeslots.push_back(handle.index);
+	}
+	/*
+	Returns the object of a live handle in O(1),
+	or nullptr when the handle is null or stale.
+	*/
+	T* resolve(entityhandle handle) const
+	{
+		if(handle.isNull()) return nullptr;
+		uint32_t page = handle.index >> page_bits;
+		if(page >= pagecount.load(std::memory_order_acquire)) return nullptr;
+		const slot& s = pages[page].load(std::memory_order_acquire)[handle.index & (page_size - 1)];
+		if(s.generation.load(std::memory_order_acquire) != handle.generation) return nullptr;
+		return s.object.load(std::memory_order_relaxed);
+	}
+	/*
+	Returns the number of live handles.
+	*/
+	std::size_t size() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return nextslot - (nextslot > 0 ? 1 : 0) - freeslots.size();
+	}
+
+private:
+	static const uint32_t page_bits = 12;
+	static const uint32_t page_size = 1u << page_bits;
+	static const uint32_t max_pages = 1u << 14;
+
+	struct slot
+	{
+		std::atomic<T*> object{nullptr};
+		std::atomic<uint32_t> generation{0};
+	};
+
+	slot& at(uint32_t index)
+	{
+		return pages[index >> page_bits].load(std::memory_order_relaxed)[index & (page_size - 1)];
+	}
+
+	mutable std::mutex lock;
+	std::atomic<slot*> pages[max_pages];
+	std::atomic<uint32_t> pagecount;
+	uint32_t nextslot = 0;
+	std::vector<uint32_t> freeslots;
+
+};
+
+#endif
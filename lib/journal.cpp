@@ -0,0 +1,193 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        journal source file
+*/
+
+#include "journal.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+std::string quoted(std::string_view field)
+{
+	std::string text = "\"";
+	for(char c : field)
+	{
+		if(c == '"' || c == '\\') text += '\\';
+		text += c;
+	}
+	text += '"';
+	return text;
+}
+
+bool blank(char c)
+{
+	return std::isspace((unsigned char)c);
+}
+
+}
+
+std::string quoteField(std::string_view field)
+{
+	if(field.empty() || field == "-" || field.front() == '"' || std::any_of(field.begin(), field.end(), blank))
+		return quoted(field);
+	return std::string(field);
+}
+
+std::string quoteLast(std::string_view field)
+{
+	//inner spaces are fine, the field runs to the end of the line
+	if(field.empty() || field == "-" || field.front() == '"' || blank(field.front()) || blank(field.back()))
+		return quoted(field);
+	return std::string(field);
+}
+
+bool readField(std::istream& in, std::string& field)
+{
+	field.clear();
+	in >> std::ws;
+	if(in.peek() != '"') return bool(in >> field);
+	in.get();
+	char c;
+	while(in.get(c))
+	{
+		if(c == '"') return true;
+		if(c == '\\' && !in.get(c)) break;
+		field += c;
+	}
+	return false;
+}
+
+bool readLast(std::istream& in, std::string& field)
+{
+	field.clear();
+	in >> std::ws;
+	if(in.peek() == '"') return readField(in, field);
+	return bool(std::getline(in, field));
+}
+
+journalwriter::journalwriter(const std::string& path)
+{
+	fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	count = 0;
+}
+
+journalwriter::~journalwriter()
+{
+	flush();
+	if(fd >= 0) close(fd);
+}
+
+bool journalwriter::isOpen() const
+{
+	return fd >= 0;
+}
+
+void journalwriter::snapshot(const hospital& hosp)
+{
+	append("HOSP " + quoteLast(hosp.getName()));
+	for(const room* r : hosp.getRoomList()) append("ROOM " + quoteLast(r -> getName()));
+	std::string line;
+	for(const staffmember* s : hosp.getStaffList())
+	{
+		line.assign("STAFF ").append(quoteField(s -> getName())).append(" ").append(quoteField(s -> getSurname()));
+		line.append(" ").append(std::to_string(s -> getAge())).append(" ").append(quoteLast(s -> getType()));
+		append(line);
+	}
+	for(const room* r : hosp.getRoomList())
+	{
+		const staffmember& s = r -> getStaff();
+		if(!s.isValid()) continue;
+		line.assign("ASSIGN ").append(quoteField(s.getName())).append(" ").append(quoteField(s.getSurname()));
+		line.append(" ").append(quoteLast(r -> getName()));
+		append(line);
+	}
+	for(const patient* p : hosp.getPatientList())
+	{
+		std::string who = quoteField(p -> getName()) + " " + quoteField(p -> getSurname());
+		line.assign("REG ").append(who).append(" ").append(std::to_string(p -> getAge()));
+		if(p -> getCondition() != "") line.append(" ").append(quoteField(p -> getCondition()));
+		append(line);
+		const room& r = p -> getRoom();
+		if(!r.isValid()) continue;
+		line.assign("MOV ").append(who).append(" ").append(quoteLast(r.getName()));
+		append(line);
+	}
+	flush();
+}
+
+void journalwriter::append(const std::string& line)
+{
+	batch.append(line).push_back('\n');
+	count++;
+}
+
+void journalwriter::flush()
+{
+	//a regular file takes the whole batch in one write, the loop
+	//only covers writes cut short by a signal or a full disk
+	std::size_t done = 0;
+	while(fd >= 0 && done < batch.size())
+	{
+		ssize_t written = write(fd, batch.data() + done, batch.size() - done);
+		if(written < 0 && errno == EINTR) continue;
+		if(written <= 0) break;
+		done += written;
+	}
+	batch.clear();
+}
+
+uint64_t journalwriter::records() const
+{
+	return count;
+}
+
+journalreader::journalreader(const std::string& pth)
+{
+	path = pth;
+	fd = -1;
+	count = 0;
+}
+
+journalreader::~journalreader()
+{
+	if(fd >= 0) close(fd);
+}
+
+std::size_t journalreader::poll(const std::function<void(const std::string&)>& apply)
+{
+	//the writer may not have created the file yet
+	if(fd < 0) fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0) return 0;
+	std::size_t passed = 0;
+	char buffer[1 << 16];
+	while(true)
+	{
+		ssize_t got = read(fd, buffer, sizeof(buffer));
+		if(got < 0 && errno == EINTR) continue;
+		//caught up with the writer
+		if(got <= 0) break;
+		partial.append(buffer, got);
+		std::size_t start = 0, end;
+		while((end = partial.find('\n', start)) != std::string::npos)
+		{
+			apply(partial.substr(start, end - start));
+			start = end + 1;
+			passed++;
+		}
+		partial.erase(0, start);
+	}
+	count += passed;
+	return passed;
+}
+
+uint64_t journalreader::records() const
+{
+	return count;
+}
@@ -0,0 +1,130 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        journal header file
+*/
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include "objects.h"
+
+/*
+Fields of the request lines. A field is a run of
+non-blank characters, or a double quoted string in
+which \" and \\ stand for a quote and a backslash, so
+names with spaces ("Smith-Jones 2") survive. The last
+field of a line (a room or hospital name) may also
+be the rest of the line, spaces included.
+
+quoteField and quoteLast write a field quoted only if
+it has to be, readField and readLast read one back,
+returning false if there is none or a quote is not
+closed. A quoted "-" is a room named '-', a bare one
+means no room.
+*/
+std::string quoteField(std::string_view field);
+std::string quoteLast(std::string_view field);
+bool readField(std::istream& in, std::string& field);
+bool readLast(std::istream& in, std::string& field);
+
+/*
+The mutation journal is a text file of request lines in
+the admissionserver protocol, one applied mutation per
+line. It opens with a snapshot of the hospital written
+with these extra records:
+
+	HOSP <hospital name>
+	ROOM <room name>
+	STAFF <name> <surname> <age> <profession>
+	ASSIGN <name> <surname> <room name>
+	REG <name> <surname> <age> [condition]
+	MOV <name> <surname> <room name>
+
+with fields quoted as in the requests (see quoteField),
+after which the server appends every REG, DIS and MOV
+it applied. Replaying the file in order on an empty
+hospital rebuilds the same state.
+*/
+class journalwriter
+{
+
+public:
+	/*
+	Creates (or truncates) the journal file.
+	*/
+	journalwriter(const std::string& path);
+	/*
+	Flushes the records still buffered.
+	*/
+	~journalwriter();
+	journalwriter(const journalwriter&) = delete;
+	journalwriter& operator=(const journalwriter&) = delete;
+	/*
+	Checks if the file could be opened.
+	*/
+	bool isOpen() const;
+	/*
+	Writes the records describing the current state of
+	a hospital, so a replica can start from it.
+	*/
+	void snapshot(const hospital& hosp);
+	/*
+	Buffers one record. It reaches the file on flush().
+	*/
+	void append(const std::string& line);
+	/*
+	Writes out the buffered records in a single write, so
+	a tailing reader sees a whole batch at once.
+	*/
+	void flush();
+	/*
+	Returns the number of records appended so far.
+	*/
+	uint64_t records() const;
+
+private:
+	int fd;
+	//records appended since the last flush
+	std::string batch;
+	uint64_t count;
+
+};
+
+/*
+Follows a journal file while it grows, like 'tail -f'.
+The file does not need to exist yet.
+*/
+class journalreader
+{
+
+public:
+	journalreader(const std::string& path);
+	~journalreader();
+	journalreader(const journalreader&) = delete;
+	journalreader& operator=(const journalreader&) = delete;
+	/*
+	Passes every complete record written since the last
+	call to apply, in order. Returns how many were passed.
+	*/
+	std::size_t poll(const std::function<void(const std::string&)>& apply);
+	/*
+	Returns the number of records read so far.
+	*/
+	uint64_t records() const;
+
+private:
+	std::string path;
+	int fd;
+	//start of a record not completely written yet
+	std::string partial;
+	uint64_t count;
+
+};
+
+#endif
@@ -0,0 +1,431 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+    census kernels source file
+*/
+
+#include "kernels.h"
+#include "objects.h"
+#include "conditions.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define kernels_x86
+#endif
+
+namespace
+{
+
+//partial result of the age statistics kernels
+struct agesum
+{
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint8_t min = 255;
+	uint8_t max = 0;
+};
+
+//sentinel until the first kernel call picks a level
+std::atomic<int> active_level{-1};
+
+//highest histogram bound the SIMD kernels keep in registers
+const int max_simd_bounds = 32;
+
+/*
+[][][][][!] SCALAR KERNELS [!][][][][]
+*/
+
+agesum statsScalar(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key)
+{
+	agesum res;
+	for(std::size_t i = 0; i < n; i++)
+	{
+		if(keys != nullptr && keys[i] != key) continue;
+		res.count++;
+		res.sum += ages[i];
+		res.min = std::min(res.min, ages[i]);
+		res.max = std::max(res.max, ages[i]);
+	}
+	return res;
+}
+
+//counts matching rows with age below every bound, and all matching rows
+void belowScalar(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key,
+	const uint8_t* bounds, int nbounds, uint64_t* below, uint64_t& total)
+{
+	for(std::size_t i = 0; i < n; i++)
+	{
+		if(keys != nullptr && keys[i] != key) continue;
+		total++;
+		for(int j = 0; j < nbounds; j++) below[j] += ages[i] < bounds[j];
+	}
+}
+
+/*
+[][][][][!] SSE2 KERNELS [!][][][][]
+*/
+
+#ifdef kernels_x86
+
+//byte mask of 16 rows whose key equals kv
+__attribute__((target("sse2")))
+inline __m128i maskSse2(const uint32_t* keys, __m128i kv)
+{
+	__m128i m0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys)), kv);
+	__m128i m1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + 4)), kv);
+	__m128i m2 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + 8)), kv);
+	__m128i m3 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + 12)), kv);
+	//saturating packs keep -1 and 0, and the row order
+	return _mm_packs_epi16(_mm_packs_epi32(m0, m1), _mm_packs_epi32(m2, m3));
+}
+
+__attribute__((target("sse2")))
+agesum statsSse2(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key)
+{
+	const __m128i ones = _mm_set1_epi8(-1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i kv = _mm_set1_epi32(int(key));
+	__m128i vmin = ones, vmax = zero, vsum = zero;
+	uint64_t count = 0;
+	std::size_t i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(ages + i));
+		__m128i m = keys != nullptr ? maskSse2(keys + i, kv) : ones;
+		__m128i am = _mm_and_si128(a, m);
+		//rows outside the mask count as 255 for min and 0 for max
+		vmin = _mm_min_epu8(vmin, _mm_or_si128(a, _mm_andnot_si128(m, ones)));
+		vmax = _mm_max_epu8(vmax, am);
+		vsum = _mm_add_epi64(vsum, _mm_sad_epu8(am, zero));
+		count += __builtin_popcount(_mm_movemask_epi8(m));
+	}
+	alignas(16) uint8_t mins[16], maxs[16];
+	alignas(16) uint64_t sums[2];
+	_mm_store_si128((__m128i*)mins, vmin);
+	_mm_store_si128((__m128i*)maxs, vmax);
+	_mm_store_si128((__m128i*)sums, vsum);
+	agesum res = statsScalar(ages + i, keys != nullptr ? keys + i : nullptr, n - i, key);
+	res.count += count;
+	res.sum += sums[0] + sums[1];
+	for(int j = 0; j < 16; j++)
+	{
+		res.min = std::min(res.min, mins[j]);
+		res.max = std::max(res.max, maxs[j]);
+	}
+	return res;
+}
+
+/*
+Counts rows below each bound with byte-wide compares.
+Byte counters are flushed every 255 steps, before
+they can overflow.
+*/
+__attribute__((target("sse2")))
+void belowSse2(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key,
+	const uint8_t* bounds, int nbounds, uint64_t* below, uint64_t& total)
+{
+	const __m128i ones = _mm_set1_epi8(-1);
+	const __m128i zero = _mm_setzero_si128();
+	//unsigned compare done as signed one on biased values
+	const __m128i bias = _mm_set1_epi8(char(0x80));
+	const __m128i kv = _mm_set1_epi32(int(key));
+	__m128i bv[max_simd_bounds], acc[max_simd_bounds];
+	for(int j = 0; j < nbounds; j++) bv[j] = _mm_set1_epi8(char(bounds[j] ^ 0x80));
+	std::size_t i = 0;
+	while(i + 16 <= n)
+	{
+		for(int j = 0; j < nbounds; j++) acc[j] = zero;
+		__m128i tacc = zero;
+		for(int step = 0; step < 255 && i + 16 <= n; step++, i += 16)
+		{
+			__m128i a = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(ages + i)), bias);
+			__m128i m = keys != nullptr ? maskSse2(keys + i, kv) : ones;
+			for(int j = 0; j < nbounds; j++)
+				acc[j] = _mm_sub_epi8(acc[j], _mm_and_si128(_mm_cmpgt_epi8(bv[j], a), m));
+			tacc = _mm_sub_epi8(tacc, m);
+		}
+		alignas(16) uint64_t sums[2];
+		for(int j = 0; j < nbounds; j++)
+		{
+			_mm_store_si128((__m128i*)sums, _mm_sad_epu8(acc[j], zero));
+			below[j] += sums[0] + sums[1];
+		}
+		_mm_store_si128((__m128i*)sums, _mm_sad_epu8(tacc, zero));
+		total += sums[0] + sums[1];
+	}
+	belowScalar(ages + i, keys != nullptr ? keys + i : nullptr, n - i, key, bounds, nbounds, below, total);
+}
+
+/*
+[][][][][!] AVX2 KERNELS [!][][][][]
+*/
+
+//byte mask of 32 rows whose key equals kv
+__attribute__((target("avx2")))
+inline __m256i maskAvx2(const uint32_t* keys, __m256i kv)
+{
+	__m256i m0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(keys)), kv);
+	__m256i m1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(keys + 8)), kv);
+	__m256i m2 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(keys + 16)), kv);
+	__m256i m3 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(keys + 24)), kv);
+	__m256i m = _mm256_packs_epi16(_mm256_packs_epi32(m0, m1), _mm256_packs_epi32(m2, m3));
+	//packs work per 128-bit lane, restore the row order
+	return _mm256_permutevar8x32_epi32(m, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+__attribute__((target("avx2,popcnt")))
+agesum statsAvx2(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key)
+{
+	const __m256i ones = _mm256_set1_epi8(-1);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i kv = _mm256_set1_epi32(int(key));
+	__m256i vmin = ones, vmax = zero, vsum = zero;
+	uint64_t count = 0;
+	std::size_t i = 0;
+	for(; i + 32 <= n; i += 32)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(ages + i));
+		__m256i m = keys != nullptr ? maskAvx2(keys + i, kv) : ones;
+		__m256i am = _mm256_and_si256(a, m);
+		vmin = _mm256_min_epu8(vmin, _mm256_or_si256(a, _mm256_andnot_si256(m, ones)));
+		vmax = _mm256_max_epu8(vmax, am);
+		vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(am, zero));
+		count += __builtin_popcount(uint32_t(_mm256_movemask_epi8(m)));
+	}
+	alignas(32) uint8_t mins[32], maxs[32];
+	alignas(32) uint64_t sums[4];
+	_mm256_store_si256((__m256i*)mins, vmin);
+	_mm256_store_si256((__m256i*)maxs, vmax);
+	_mm256_store_si256((__m256i*)sums, vsum);
+	agesum res = statsScalar(ages + i, keys != nullptr ? keys + i : nullptr, n - i, key);
+	res.count += count;
+	res.sum += sums[0] + sums[1] + sums[2] + sums[3];
+	for(int j = 0; j < 32; j++)
+	{
+		res.min = std::min(res.min, mins[j]);
+		res.max = std::max(res.max, maxs[j]);
+	}
+	return res;
+}
+
+__attribute__((target("avx2")))
+void belowAvx2(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key,
+	const uint8_t* bounds, int nbounds, uint64_t* below, uint64_t& total)
+{
+	const __m256i ones = _mm256_set1_epi8(-1);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i bias = _mm256_set1_epi8(char(0x80));
+	const __m256i kv = _mm256_set1_epi32(int(key));
+	__m256i bv[max_simd_bounds], acc[max_simd_bounds];
+	for(int j = 0; j < nbounds; j++) bv[j] = _mm256_set1_epi8(char(bounds[j] ^ 0x80));
+	std::size_t i = 0;
+	while(i + 32 <= n)
+	{
+		for(int j = 0; j < nbounds; j++) acc[j] = zero;
+		__m256i tacc = zero;
+		for(int step = 0; step < 255 && i + 32 <= n; step++, i += 32)
+		{
+			__m256i a = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(ages + i)), bias);
+			__m256i m = keys != nullptr ? maskAvx2(keys + i, kv) : ones;
+			for(int j = 0; j < nbounds; j++)
+				acc[j] = _mm256_sub_epi8(acc[j], _mm256_and_si256(_mm256_cmpgt_epi8(bv[j], a), m));
+			tacc = _mm256_sub_epi8(tacc, m);
+		}
+		alignas(32) uint64_t sums[4];
+		for(int j = 0; j < nbounds; j++)
+		{
+			_mm256_store_si256((__m256i*)sums, _mm256_sad_epu8(acc[j], zero));
+			below[j] += sums[0] + sums[1] + sums[2] + sums[3];
+		}
+		_mm256_store_si256((__m256i*)sums, _mm256_sad_epu8(tacc, zero));
+		total += sums[0] + sums[1] + sums[2] + sums[3];
+	}
+	belowScalar(ages + i, keys != nullptr ? keys + i : nullptr, n - i, key, bounds, nbounds, below, total);
+}
+
+#endif
+
+/*
+[][][][][!] DISPATCH [!][][][][]
+*/
+
+kernellevel currentLevel()
+{
+	int level = active_level.load(std::memory_order_relaxed);
+	if(level < 0)
+	{
+		level = detectKernelLevel();
+		active_level.store(level, std::memory_order_relaxed);
+	}
+	return kernellevel(level);
+}
+
+agesum ageStats(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key)
+{
+	switch(currentLevel())
+	{
+#ifdef kernels_x86
+	case kernel_avx2: return statsAvx2(ages, keys, n, key);
+	case kernel_sse2: return statsSse2(ages, keys, n, key);
+#endif
+	default: return statsScalar(ages, keys, n, key);
+	}
+}
+
+void countBelow(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key,
+	const uint8_t* bounds, int nbounds, uint64_t* below, uint64_t& total)
+{
+	switch(nbounds <= max_simd_bounds ? currentLevel() : kernel_scalar)
+	{
+#ifdef kernels_x86
+	case kernel_avx2: belowAvx2(ages, keys, n, key, bounds, nbounds, below, total); break;
+	case kernel_sse2: belowSse2(ages, keys, n, key, bounds, nbounds, below, total); break;
+#endif
+	default: belowScalar(ages, keys, n, key, bounds, nbounds, below, total);
+	}
+}
+
+agestats finish(const agesum& sum)
+{
+	agestats res;
+	res.count = sum.count;
+	res.min = sum.count != 0 ? sum.min : 0;
+	res.max = sum.max;
+	res.mean = sum.count != 0 ? double(sum.sum) / sum.count : 0;
+	return res;
+}
+
+/*
+Adds 1 to counts[ids[i]] for every matching row. Four
+interleaved tables keep back-to-back increments of the
+same ID from waiting on each other.
+*/
+void countIds(const uint32_t* ids, const uint32_t* keys, std::size_t n, uint32_t key, std::vector<uint64_t>& counts)
+{
+	std::vector<uint64_t> split(counts.size() * 4, 0);
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
+	{
+		for(int lane = 0; lane < 4; lane++)
+		{
+			bool match = keys == nullptr || keys[i + lane] == key;
+			split[ids[i + lane] * 4 + lane] += match;
+		}
+	}
+	for(; i < n; i++)
+		if(keys == nullptr || keys[i] == key) counts[ids[i]]++;
+	for(std::size_t c = 0; c < split.size(); c++) counts[c / 4] += split[c];
+}
+
+/*
+Adds 1 to bins[binof[ages[i]]] for every matching row, with
+interleaved tables as in countIds. Unlike countBelow its
+cost does not grow with the number of bins.
+*/
+void binAges(const uint8_t* ages, const uint32_t* keys, std::size_t n, uint32_t key, const uint8_t* binof, std::vector<uint64_t>& bins)
+{
+	std::vector<uint64_t> split(bins.size() * 4, 0);
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4)
+	{
+		for(int lane = 0; lane < 4; lane++)
+		{
+			bool match = keys == nullptr || keys[i + lane] == key;
+			split[binof[ages[i + lane]] * 4 + lane] += match;
+		}
+	}
+	for(; i < n; i++)
+		if(keys == nullptr || keys[i] == key) bins[binof[ages[i]]]++;
+	for(std::size_t b = 0; b < split.size(); b++) bins[b / 4] += split[b];
+}
+
+}
+
+kernellevel detectKernelLevel()
+{
+#ifdef kernels_x86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) return kernel_avx2;
+	if(__builtin_cpu_supports("sse2")) return kernel_sse2;
+#endif
+	return kernel_scalar;
+}
+
+kernellevel getKernelLevel()
+{
+	return currentLevel();
+}
+
+void setKernelLevel(kernellevel level)
+{
+	active_level.store(std::min(level, detectKernelLevel()), std::memory_order_relaxed);
+}
+
+agestats ageStatsByHospital(const patientcolumns& cols, uint32_t hospitalid)
+{
+	const uint32_t* keys = hospitalid != 0 ? cols.hospitals() : nullptr;
+	return finish(ageStats(cols.ages(), keys, cols.size(), hospitalid));
+}
+
+agestats ageStatsByHospital(const patientcolumns& cols, const hospital& hosp)
+{
+	return ageStatsByHospital(cols, hosp.getHandle().index);
+}
+
+agestats ageStatsByRoom(const patientcolumns& cols, uint32_t roomid)
+{
+	return finish(ageStats(cols.ages(), cols.rooms(), cols.size(), roomid));
+}
+
+std::vector<uint64_t> ageHistogram(const patientcolumns& cols, uint32_t hospitalid, unsigned binwidth)
+{
+	if(binwidth == 0) binwidth = 1;
+	int nbins = 200 / binwidth + 1;
+	const uint32_t* keys = hospitalid != 0 ? cols.hospitals() : nullptr;
+	std::vector<uint64_t> bins(nbins, 0);
+	//counting below every bound costs a compare per bound and row, so
+	//without SIMD or with many narrow bins every age is binned directly
+	if(nbins - 1 > max_simd_bounds || currentLevel() == kernel_scalar)
+	{
+		uint8_t binof[256];
+		for(int age = 0; age < 256; age++) binof[age] = uint8_t(std::min(age / int(binwidth), nbins - 1));
+		binAges(cols.ages(), keys, cols.size(), hospitalid, binof, bins);
+		return bins;
+	}
+	//bin i is the difference of counts below bounds i and i-1
+	std::vector<uint8_t> bounds;
+	for(int b = 1; b < nbins; b++) bounds.push_back(uint8_t(b * binwidth));
+	std::vector<uint64_t> below(bounds.size(), 0);
+	uint64_t total = 0;
+	countBelow(cols.ages(), keys, cols.size(), hospitalid, bounds.data(), int(bounds.size()), below.data(), total);
+	uint64_t previous = 0;
+	for(int b = 0; b + 1 < nbins; b++)
+	{
+		bins[b] = below[b] - previous;
+		previous = below[b];
+	}
+	bins[nbins - 1] = total - previous;
+	return bins;
+}
+
+std::vector<uint64_t> conditionCounts(const patientcolumns& cols, uint32_t hospitalid)
+{
+	std::vector<uint64_t> counts(conditionCount(), 0);
+	const uint32_t* keys = hospitalid != 0 ? cols.hospitals() : nullptr;
+	countIds(cols.conditions(), keys, cols.size(), hospitalid, counts);
+	return counts;
+}
+
+std::vector<uint64_t> roomOccupancy(const patientcolumns& cols, uint32_t hospitalid)
+{
+	const uint32_t* rooms = cols.rooms();
+	uint32_t highest = 0;
+	for(std::size_t i = 0; i < cols.size(); i++) highest = std::max(highest, rooms[i]);
+	std::vector<uint64_t> counts(std::size_t(highest) + 1, 0);
+	const uint32_t* keys = hospitalid != 0 ? cols.hospitals() : nullptr;
+	countIds(rooms, keys, cols.size(), hospitalid, counts);
+	return counts;
+}
@@ -0,0 +1,90 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+    census kernels header file
+*/
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstdint>
+#include <vector>
+#include "columns.h"
+
+class hospital;
+
+/*
+Aggregate functions over a patientcolumns store. The
+age kernels (statistics and histogram) have SSE2 and
+AVX2 versions next to the plain scalar one; the best
+one supported by the CPU is picked on first use.
+Counting kernels (conditions, occupancy) are bound by
+scattered increments rather than arithmetic, so they
+use an unrolled scalar loop with split counters.
+
+Functions taking a hospital ID only count rows of that
+hospital (its handle slot index); 0 counts every row.
+*/
+
+/*
+Instruction set levels of the age kernels.
+*/
+enum kernellevel
+{
+	kernel_scalar,
+	kernel_sse2,
+	kernel_avx2
+};
+
+/*
+Summary of the ages of a group of patients.
+Min and max are 0 when count is 0.
+*/
+struct agestats
+{
+	uint64_t count;
+	uint8_t min;
+	uint8_t max;
+	double mean;
+};
+
+/*
+Returns the best level supported by this CPU.
+*/
+kernellevel detectKernelLevel();
+/*
+Returns the level currently used by the kernels.
+*/
+kernellevel getKernelLevel();
+/*
+Forces a level, e.g. to compare them in benchmarks.
+Levels above detectKernelLevel() are lowered to it.
+*/
+void setKernelLevel(kernellevel level);
+
+/*
+Age statistics of the patients of a hospital.
+*/
+agestats ageStatsByHospital(const patientcolumns& cols, uint32_t hospitalid);
+agestats ageStatsByHospital(const patientcolumns& cols, const hospital& hosp);
+/*
+Age statistics of the patients of a single room
+(ward). Room ID 0 selects patients without a room.
+*/
+agestats ageStatsByRoom(const patientcolumns& cols, uint32_t roomid);
+/*
+Age histogram of a hospital. Bin i counts ages in
+[i*binwidth; (i+1)*binwidth), covering ages up to 200.
+*/
+std::vector<uint64_t> ageHistogram(const patientcolumns& cols, uint32_t hospitalid, unsigned binwidth);
+/*
+Number of patients per condition ID, indexed by the ID.
+*/
+std::vector<uint64_t> conditionCounts(const patientcolumns& cols, uint32_t hospitalid);
+/*
+Number of patients per room ID, indexed by the ID.
+Entry 0 counts patients without a room.
+*/
+std::vector<uint64_t> roomOccupancy(const patientcolumns& cols, uint32_t hospitalid);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        keyfilter source file
+*/
+
+#include "keyfilter.h"
+#include "registry.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+constexpr unsigned block_counters = 128;
+constexpr uint64_t counter_max = 15;
+//blocked filters fill unevenly, so they need some more counters per key
+constexpr double block_slack = 1.2;
+
+//counters per key for a false positive rate, as in a plain Bloom filter
+double countersPerKey(double fprate)
+{
+	fprate = std::clamp(fprate, 1e-9, 0.5);
+	return -std::log(fprate) / (std::log(2.0) * std::log(2.0));
+}
+
+}
+
+keyfilter::keyfilter(std::size_t count, double fprate, std::pmr::memory_resource* resource) : blocks(resource)
+{
+	this -> fprate = fprate;
+	probes = std::clamp<unsigned>(unsigned(std::lround(countersPerKey(fprate) * std::log(2.0))), 1, 16);
+	reset(count);
+}
+
+void keyfilter::add(uint64_t hash)
+{
+	hash = remix(hash);
+	block& blk = blocks[blockOf(hash)];
+	for(unsigned i = 0; i < probes; i++)
+	{
+		unsigned counter = counterOf(hash, i);
+		uint64_t& word = blk.words[counter / 16];
+		unsigned shift = (counter % 16) * 4;
+		if(((word >> shift) & counter_max) != counter_max) word += uint64_t(1) << shift;
+	}
+	keys++;
+}
+
+void keyfilter::remove(uint64_t hash)
+{
+	hash = remix(hash);
+	block& blk = blocks[blockOf(hash)];
+	for(unsigned i = 0; i < probes; i++)
+	{
+		unsigned counter = counterOf(hash, i);
+		uint64_t& word = blk.words[counter / 16];
+		unsigned shift = (counter % 16) * 4;
+		uint64_t value = (word >> shift) & counter_max;
+		//a saturated counter may hold more keys than it can count
+		if(value != 0 && value != counter_max) word -= uint64_t(1) << shift;
+	}
+	if(keys > 0) keys--;
+}
+
+bool keyfilter::mayContain(uint64_t hash) const
+{
+	hash = remix(hash);
+	const block& blk = blocks[blockOf(hash)];
+	for(unsigned i = 0; i < probes; i++)
+	{
+		unsigned counter = counterOf(hash, i);
+		if(((blk.words[counter / 16] >> ((counter % 16) * 4)) & counter_max) == 0) return false;
+	}
+	return true;
+}
+
+std::size_t keyfilter::size() const
+{
+	return keys;
+}
+
+std::size_t keyfilter::capacity() const
+{
+	return limit;
+}
+
+void keyfilter::reset(std::size_t count)
+{
+	double perkey = countersPerKey(fprate) * block_slack;
+	std::size_t count_blocks = std::max<std::size_t>(1, std::size_t(std::ceil(count * perkey / block_counters)));
+	blocks.assign(count_blocks, block{});
+	limit = std::size_t(count_blocks * block_counters / perkey);
+	keys = 0;
+}
+
+double keyfilter::rate() const
+{
+	return fprate;
+}
+
+std::size_t keyfilter::bytes() const
+{
+	return blocks.size() * sizeof(block);
+}
+
+std::size_t keyfilter::blockOf(uint64_t hash) const
+{
+	//maps the hash onto the blocks without a division
+	return std::size_t((unsigned __int128)hash * blocks.size() >> 64);
+}
+
+unsigned keyfilter::counterOf(uint64_t hash, unsigned i)
+{
+	//double hashing on the low bits, the block took the high ones
+	uint32_t first = uint32_t(hash);
+	uint32_t step = uint32_t(hash >> 17) | 1;
+	return (first + i * step) >> 25;
+}
@@ -0,0 +1,88 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        keyfilter header file
+*/
+
+#ifndef KEYFILTER_H
+#define KEYFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/*
+A counting Bloom filter over 64 bit key hashes. It
+answers "certainly absent" or "maybe present", so a
+lookup of a key that is not there can usually skip the
+index it guards. Keys can be removed again.
+
+The counters of a key all lie in one 64 byte block, so
+a query touches one cache line. Counters take 4 bits
+and stick at 15, a saturated counter is never decreased
+(it could belong to other keys), so there are no false
+negatives, only a slowly rising false positive rate.
+
+Sized for a number of keys at a target false positive
+rate, which it keeps from 10% down to about 1%. Below
+that the blocks fill too unevenly, a 0.1% target gives
+about 0.4%. Adding more keys raises the rate, the owner
+is expected to rebuild it bigger (see filteredpolicy).
+*/
+class keyfilter
+{
+
+public:
+	/*
+	Starts empty, sized for count keys at the given false
+	positive rate, taking memory from the given resource.
+	*/
+	keyfilter(std::size_t count, double fprate, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/*
+	Adds and removes a key. Only remove keys that were
+	added, or the filter may forget others.
+	*/
+	void add(uint64_t hash);
+	void remove(uint64_t hash);
+	/*
+	Returns false if the key was certainly not added.
+	*/
+	bool mayContain(uint64_t hash) const;
+	/*
+	Returns the number of keys added and not removed, and
+	the number it is sized for.
+	*/
+	std::size_t size() const;
+	std::size_t capacity() const;
+	/*
+	Empties the filter and sizes it for count keys.
+	*/
+	void reset(std::size_t count);
+	/*
+	Returns the target false positive rate, and the bytes
+	the counters take.
+	*/
+	double rate() const;
+	std::size_t bytes() const;
+
+private:
+	//128 counters of 4 bits, one cache line
+	struct alignas(64) block
+	{
+		uint64_t words[8];
+	};
+	std::pmr::vector<block> blocks;
+	double fprate;
+	std::size_t keys;
+	std::size_t limit;
+	//counters set per key
+	unsigned probes;
+
+	//the block of a key, and the counter of its i-th probe
+	std::size_t blockOf(uint64_t hash) const;
+	static unsigned counterOf(uint64_t hash, unsigned i);
+
+};
+
+#endif
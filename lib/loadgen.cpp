@@ -0,0 +1,166 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+     load generator source file
+*/
+
+#include "loadgen.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+typedef std::chrono::steady_clock loadclock;
+
+struct loadconnection
+{
+	int fd = -1;
+	unsigned id = 0;
+	uint64_t quota = 0;
+	uint64_t sent = 0;
+	uint64_t answered = 0;
+	std::string input;
+	std::string output;
+	//send time of every request still in flight, in order
+	std::deque<loadclock::time_point> inflight;
+};
+
+int connectTo(const std::string& path)
+{
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(addr.sun_path)) return -1;
+	std::strcpy(addr.sun_path, path.c_str());
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0) return -1;
+	if(connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+//the n-th request of a connection: REG, GET, GET, DIS of patient n/4
+std::string makeRequest(unsigned id, uint64_t n)
+{
+	std::string who = "L" + std::to_string(id) + " P" + std::to_string(n / 4);
+	switch(n % 4)
+	{
+		case 0: return "REG " + who + " " + std::to_string(n % 90 + 1) + "\n";
+		case 3: return "DIS " + who + "\n";
+		default: return "GET " + who + "\n";
+	}
+}
+
+double percentile(const std::vector<double>& sorted, double share)
+{
+	if(sorted.empty()) return 0;
+	std::size_t at = std::size_t(share * (sorted.size() - 1));
+	return sorted[at];
+}
+
+}
+
+loadreport runLoad(const std::string& path, uint64_t requests, unsigned connections, unsigned depth)
+{
+	loadreport report = {0, 0, 0, 0, 0, 0, 0};
+	if(connections == 0 || depth == 0) return report;
+	std::vector<loadconnection> conns(connections);
+	int epoll = epoll_create1(EPOLL_CLOEXEC);
+	if(epoll < 0) return report;
+	for(unsigned c = 0; c < connections; c++)
+	{
+		conns[c].fd = connectTo(path);
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.u32 = c;
+		if(conns[c].fd < 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, conns[c].fd, &ev) < 0)
+		{
+			for(loadconnection& conn : conns) if(conn.fd >= 0) close(conn.fd);
+			close(epoll);
+			return report;
+		}
+		conns[c].id = c;
+		conns[c].quota = requests / connections + (c < requests % connections ? 1 : 0);
+	}
+	std::vector<double> latencies;
+	latencies.reserve(requests);
+	epoll_event events[64];
+	char buffer[1 << 16];
+	uint64_t done = 0;
+	loadclock::time_point begin = loadclock::now();
+	while(done < requests)
+	{
+		//top up every connection to its pipeline depth
+		for(loadconnection& conn : conns)
+		{
+			while(conn.sent < conn.quota && conn.inflight.size() < depth)
+			{
+				conn.output += makeRequest(conn.id, conn.sent++);
+				conn.inflight.push_back(loadclock::now());
+			}
+			if(!conn.output.empty())
+			{
+				ssize_t put = send(conn.fd, conn.output.data(), conn.output.size(), MSG_NOSIGNAL);
+				if(put > 0) conn.output.erase(0, put);
+				else if(errno != EINTR && errno != EAGAIN) done = requests;
+			}
+		}
+		int count = epoll_wait(epoll, events, 64, 1000);
+		if(count < 0 && errno != EINTR) break;
+		for(int i = 0; i < count; i++)
+		{
+			loadconnection& conn = conns[events[i].data.u32];
+			ssize_t got = recv(conn.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+			if(got <= 0)
+			{
+				if(got == 0 || (errno != EAGAIN && errno != EINTR)) done = requests;
+				continue;
+			}
+			conn.input.append(buffer, got);
+			loadclock::time_point now = loadclock::now();
+			std::size_t start = 0, end;
+			while((end = conn.input.find('\n', start)) != std::string::npos)
+			{
+				if(conn.input.compare(start, 3, "ERR") == 0) report.errors++;
+				start = end + 1;
+				if(conn.inflight.empty()) continue;
+				latencies.push_back(std::chrono::duration<double, std::micro>(now - conn.inflight.front()).count());
+				conn.inflight.pop_front();
+				conn.answered++;
+				done++;
+			}
+			conn.input.erase(0, start);
+		}
+	}
+	report.seconds = std::chrono::duration<double>(loadclock::now() - begin).count();
+	for(loadconnection& conn : conns) close(conn.fd);
+	close(epoll);
+	std::sort(latencies.begin(), latencies.end());
+	report.requests = latencies.size();
+	report.p50 = percentile(latencies, 0.5);
+	report.p99 = percentile(latencies, 0.99);
+	report.p999 = percentile(latencies, 0.999);
+	report.max = latencies.empty() ? 0 : latencies.back();
+	return report;
+}
+
+void printLoadReport(std::ostream& out, const loadreport& report)
+{
+	out << "requests,seconds,req_per_sec,p50_us,p99_us,p999_us,max_us,errors" << std::endl;
+	out << report.requests << "," << report.seconds << ",";
+	out << (report.seconds > 0 ? report.requests / report.seconds : 0) << ",";
+	out << report.p50 << "," << report.p99 << "," << report.p999 << ",";
+	out << report.max << "," << report.errors << std::endl;
+}
@@ -0,0 +1,45 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+     load generator header file
+*/
+
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+Results of a load run. Latencies are in microseconds,
+measured from sending a request to reading its answer.
+*/
+struct loadreport
+{
+	uint64_t requests;
+	uint64_t errors;
+	double seconds;
+	double p50;
+	double p99;
+	double p999;
+	double max;
+};
+
+/*
+Drives an admissionserver listening on a socket path.
+Opens the given number of connections and keeps up to
+depth requests in flight on each (pipelining). Every
+connection cycles through REG, GET, GET and DIS of its
+own patients, so half of the requests are mutations.
+Returns a report with requests = 0 if no connection
+could be made.
+*/
+loadreport runLoad(const std::string& path, uint64_t requests, unsigned connections, unsigned depth);
+/*
+Prints a report as a CSV header and line:
+requests,seconds,req_per_sec,p50_us,p99_us,p999_us,max_us,errors
+*/
+void printLoadReport(std::ostream& out, const loadreport& report);
+
+#endif
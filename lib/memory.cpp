@@ -0,0 +1,121 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        memory source file
+*/
+
+#include "memory.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+
+countingresource::countingresource(std::pmr::memory_resource* upstream)
+{
+	next = upstream;
+	inuse = 0;
+	peak = 0;
+	total = 0;
+	count = 0;
+}
+
+std::pmr::memory_resource* countingresource::upstream() const
+{
+	return next;
+}
+
+uint64_t countingresource::bytesInUse() const
+{
+	return inuse;
+}
+
+uint64_t countingresource::peakBytes() const
+{
+	return peak;
+}
+
+uint64_t countingresource::bytesAllocated() const
+{
+	return total;
+}
+
+uint64_t countingresource::allocations() const
+{
+	return count;
+}
+
+void* countingresource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	void* ptr = next -> allocate(bytes, alignment);
+	inuse += bytes;
+	total += bytes;
+	count++;
+	if(inuse > peak) peak = inuse;
+	return ptr;
+}
+
+void countingresource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+	next -> deallocate(ptr, bytes, alignment);
+	inuse -= bytes;
+}
+
+bool countingresource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+
+fixedarena::fixedarena(std::size_t size) : bytes(size), buffer(new std::byte[size])
+{
+	used = 0;
+	for(void*& list : freed) list = nullptr;
+}
+
+std::size_t fixedarena::capacity() const
+{
+	return bytes;
+}
+
+std::size_t fixedarena::claimed() const
+{
+	return used;
+}
+
+unsigned fixedarena::sizeClass(std::size_t size, std::size_t alignment)
+{
+	std::size_t block = std::max({size, alignment, min_block});
+	return std::bit_width(block - 1);
+}
+
+void* fixedarena::do_allocate(std::size_t size, std::size_t alignment)
+{
+	unsigned sclass = sizeClass(size, alignment);
+	//every block of a class meets any alignment up to block_align, so only
+	//a stricter request has to check the freed block it would be given
+	void* head = freed[sclass];
+	if(head != nullptr && (alignment <= block_align || reinterpret_cast<uintptr_t>(head) % alignment == 0))
+	{
+		std::memcpy(&freed[sclass], head, sizeof(void*));
+		return head;
+	}
+	//blocks are aligned to their own size, up to block_align
+	std::size_t block = std::size_t(1) << sclass;
+	std::size_t align = std::max(alignment, std::min(block, block_align));
+	uintptr_t base = reinterpret_cast<uintptr_t>(buffer.get());
+	std::size_t start = (base + used + align - 1) / align * align - base;
+	if(start > bytes || bytes - start < block) throw std::bad_alloc();
+	used = start + block;
+	return buffer.get() + start;
+}
+
+void fixedarena::do_deallocate(void* ptr, std::size_t size, std::size_t alignment)
+{
+	unsigned sclass = sizeClass(size, alignment);
+	std::memcpy(ptr, &freed[sclass], sizeof(void*));
+	freed[sclass] = ptr;
+}
+
+bool fixedarena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
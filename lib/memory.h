@@ -0,0 +1,108 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        memory header file
+*/
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+/*
+A memory resource passing every request on to another
+one and counting what goes through it. Every hospital
+allocates its containers through one (see
+hospital::getMemory), so its memory can be reported
+whichever resource it was given, e.g. a
+std::pmr::monotonic_buffer_resource for a short-lived
+simulation or a std::pmr::unsynchronized_pool_resource
+for a long-lived hospital.
+
+Like the hospital itself it is not thread-safe.
+*/
+class countingresource : public std::pmr::memory_resource
+{
+
+public:
+	countingresource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	/*
+	Returns the resource requests are passed on to.
+	*/
+	std::pmr::memory_resource* upstream() const;
+	/*
+	Return the bytes allocated and not yet freed, the
+	highest that value has been, and the bytes and the
+	number of allocations made in total.
+	*/
+	uint64_t bytesInUse() const;
+	uint64_t peakBytes() const;
+	uint64_t bytesAllocated() const;
+	uint64_t allocations() const;
+
+private:
+	std::pmr::memory_resource* next;
+	uint64_t inuse;
+	uint64_t peak;
+	uint64_t total;
+	uint64_t count;
+
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+};
+
+/*
+A memory resource with a fixed amount of memory, taken
+from the heap once when it is constructed. Requests are
+rounded up to a power of two and freed blocks are kept
+on a list per size for reuse, so a workload which stays
+within a bounded size runs in the same memory forever,
+without touching the heap. Running out throws
+std::bad_alloc, so size it with some room to spare.
+
+Hospitals with fixed limits keep one (see hospitallimits).
+Like the hospital itself it is not thread-safe.
+*/
+class fixedarena : public std::pmr::memory_resource
+{
+
+public:
+	fixedarena(std::size_t bytes);
+	fixedarena(const fixedarena&) = delete;
+	fixedarena& operator=(const fixedarena&) = delete;
+	/*
+	Returns the size of the memory block, and how much of
+	it has been handed out at least once. The latter stops
+	growing once the workload reaches its steady state.
+	*/
+	std::size_t capacity() const;
+	std::size_t claimed() const;
+
+private:
+	std::size_t bytes;
+	std::unique_ptr<std::byte[]> buffer;
+	//start of the part of the buffer not handed out yet
+	std::size_t used;
+	//freed blocks of 2^i bytes, linked through their first bytes
+	void* freed[64];
+
+	//a freed block holds the link to the next one
+	static constexpr std::size_t min_block = sizeof(void*);
+	//new blocks are aligned to their size up to a cache line, so a freed
+	//block can serve any request of its size class, alignas(64) ones too
+	static constexpr std::size_t block_align = 64;
+	//returns i for blocks of 2^i bytes fitting the request
+	static unsigned sizeClass(std::size_t size, std::size_t alignment);
+
+	void* do_allocate(std::size_t size, std::size_t alignment) override;
+	void do_deallocate(void* ptr, std::size_t size, std::size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+};
+
+#endif
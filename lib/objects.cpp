@@ -5,6 +5,10 @@
 */
 
 #include "objects.h"
+#include "trace.h"
+#include "columns.h"
+#include <algorithm>
+#include "conditions.h"
 
 #ifdef debug_msg
 #define debug(method, message) std::cerr << #method << ": " << #message << "!\n"
@@ -12,21 +16,77 @@
 #define debug(method, message)
 #endif
 
+/*
+Handle tables of every entity type. Allocated on first use
+and never freed, so they outlive every static entity.
+*/
+static handletable<patient>& patientHandles()
+{
+	static handletable<patient>* table = new handletable<patient>;
+	return *table;
+}
+
+static handletable<staffmember>& staffHandles()
+{
+	static handletable<staffmember>* table = new handletable<staffmember>;
+	return *table;
+}
+
+static handletable<room>& roomHandles()
+{
+	static handletable<room>* table = new handletable<room>;
+	return *table;
+}
+
+static handletable<hospital>& hospitalHandles()
+{
+	static handletable<hospital>* table = new handletable<hospital>;
+	return *table;
+}
+
 patient empty_patient("","",0);
 staffmember empty_staff("","",0);
 room empty_room("");
 hospital empty_hospital("");
 
+/*
+"name surname" key of the fuzzy name indexes.
+*/
+static std::pmr::string fullName(std::string_view nmstr, std::string_view snstr, std::pmr::memory_resource* resource)
+{
+	std::pmr::string full(resource);
+	full.reserve(nmstr.size() + 1 + snstr.size());
+	full.append(nmstr).append(1, ' ').append(snstr);
+	return full;
+}
+
+static bool isLimited(const hospitallimits& lims)
+{
+	return lims.rooms != 0 || lims.staff != 0 || lims.patients != 0 || lims.arenabytes != 0;
+}
+
+static std::size_t arenaBytes(const hospitallimits& lims)
+{
+	if(lims.arenabytes != 0) return lims.arenabytes;
+	//measured about 1.1kB a patient in steady state. The trigram indexes
+	//keep up to max(1024, live names) erased ones before they compact,
+	//under 1kB each with their postings
+	std::size_t erased = std::max(trigramindex::compact_after, lims.patients) + std::max(trigramindex::compact_after, lims.staff);
+	return (lims.patients + lims.staff) * 2048 + lims.rooms * 1024 + erased * 1024 + (std::size_t(1) << 20);
+}
+
 /*
 
 [][][][][!] CLASS PERSON [!][][][][]
 
 */
 
-bool person::setName(std::string namestr, std::string surnamestr)
+template <class Policy>
+bool person::setName(std::string_view namestr, std::string_view surnamestr)
 {
+	trace(person::setName);
 	//check if given name or surname is not empty
-	if(namestr == "" || surnamestr == "")
+	if(!validName<Policy>(namestr, surnamestr))
 	{
 		debug(person::setName, provided name and/or surname is an empty string);
 		return false;
@@ -40,39 +100,51 @@ bool person::setName(std::string namestr, std::string surnamestr)
 	return true;
 }
 
-std::string person::getName() const
+template bool person::setName<checkedinput>(std::string_view, std::string_view);
+template bool person::setName<trustedinput>(std::string_view, std::string_view);
+
+std::string_view person::getName() const
 {
-	//return a string copy
+	trace(person::getName);
+	//a view of the stored name, no copy
 	return name;
 }
 
-std::string person::getSurname() const
+std::string_view person::getSurname() const
 {
-	//return a string copy
+	trace(person::getSurname);
+	//a view of the stored surname, no copy
 	return surname;
 }
 
+template <class Policy>
 bool person::setAge(int agecount)
 {
+	trace(person::setAge);
 	//check if age is in the impossible range
-	if(agecount < 0 || agecount > 200)
+	if(!validAge<Policy>(agecount))
 	{
 		debug(person::setAge,age was outside [0;200] range);
 		return false;
 	}
-	//set if age is correct
-	else age = agecount;
+	//set if age is correct, an unchecked one is clamped to what fits
+	else age = uint8_t(std::clamp(agecount, 0, 255));
 	return true;
 }
 
+template bool person::setAge<checkedinput>(int);
+template bool person::setAge<trustedinput>(int);
+
 int person::getAge() const
 {
+	trace(person::getAge);
 	//return a copy
 	return age;
 }
 
 bool person::isValid() const
 {
+	trace(person::isValid);
 	//check if name or surname is empty
 	if(name != "" && surname != "") return true;
 	else return false;
@@ -85,11 +157,12 @@ bool person::isValid() const
 */
 std::ostream& operator<< (std::ostream& str, const staffmember& stm)
 {
+	trace(staffmember::operator<<);
 	str << "STAFF: ";
 	//check if staff is a valid member
 	if(stm.isValid())
 	{
-		str << stm.name << " " << stm.surname << ", " << stm.age;
+		str << stm.name << " " << stm.surname << ", " << int(stm.age);
 		//check for profession and print if applicable
 		if(stm.stafftype != "") str << " | " << stm.stafftype;
 		//print out room and hospital assignments if applicable
@@ -104,21 +177,26 @@ std::ostream& operator<< (std::ostream& str, const staffmember& stm)
 
 staffmember::~staffmember()
 {
+	trace(staffmember::~staffmember);
 	//unlink any link the staff has
 	if(in_room != nullptr)
 		in_room -> unlinkStaff();
 	if(in_hospital != nullptr)
 		in_hospital -> dismissStaff(*this);
+	//handles of this staffmember go stale
+	staffHandles().release(self);
 }
 
 bool staffmember::operator==(const staffmember& ref) const
 {
+	trace(staffmember::operator==);
 	//compare name strings
 	return (name == ref.name && surname == ref.surname);
 }
 
-staffmember::staffmember(std::string namestr, std::string surnamestr, int age)
+staffmember::staffmember(std::string_view namestr, std::string_view surnamestr, int agecount)
 {
+	trace(staffmember::staffmember);
 	//initialize the pointers to null for the checks
 	//to avoid segmentation faults
 	in_hospital = nullptr;
@@ -127,48 +205,87 @@ staffmember::staffmember(std::string namestr, std::string surnamestr, int age)
 	name = namestr;
 	surname = surnamestr;
 	//if method fails, set age to 0
-	if(!setAge(age)) age = 0;
+	if(!setAge(agecount)) age = 0;
+	self = staffHandles().acquire(this);
+}
+
+staffmember::staffmember(const staffmember& ref) : person(ref)
+{
+	trace(staffmember::staffmember);
+	//a copy does not inherit links of the original
+	stafftype = ref.stafftype;
+	in_hospital = nullptr;
+	in_room = nullptr;
+	self = staffHandles().acquire(this);
+}
+
+entityhandle staffmember::getHandle() const
+{
+	trace(staffmember::getHandle);
+	return self;
 }
 
-bool staffmember::setName(std::string namestr, std::string surnamestr)
+staffmember& staffmember::fromHandle(entityhandle handle)
 {
+	trace(staffmember::fromHandle);
+	staffmember* stm = staffHandles().resolve(handle);
+	//stale handles reference an empty staff member
+	if(stm == nullptr) return empty_staff;
+	return *stm;
+}
+
+template <class Policy>
+bool staffmember::setName(std::string_view namestr, std::string_view surnamestr)
+{
+	trace(staffmember::setName);
 	//when person is linked anywhere, refuse to change name
 	if(in_hospital != nullptr || in_room != nullptr)
 	{
 		debug(staffmember::setName, object is linked - you cannot change its name);
 		return false;
 	}
-	return person::setName(namestr, surnamestr);
+	return person::setName<Policy>(namestr, surnamestr);
 	
 }
 
+template bool staffmember::setName<checkedinput>(std::string_view, std::string_view);
+template bool staffmember::setName<trustedinput>(std::string_view, std::string_view);
+
+template <class Policy>
 bool staffmember::setType(std::string typestr)
 {
+	trace(staffmember::setType);
 	//cannot assign empty string
-	if(typestr == "")
+	if(!validText<Policy>(typestr))
 	{
 		debug(staffmember::setType, provided string is empty);
 		return false;
 	}
 	//string is not empty, set value
-	else stafftype = typestr;
+	else stafftype = std::move(typestr);
 	return true;
 }
 
-std::string staffmember::getType() const
+template bool staffmember::setType<checkedinput>(std::string);
+template bool staffmember::setType<trustedinput>(std::string);
+
+const std::string& staffmember::getType() const
 {
-	//return a string copy
+	trace(staffmember::getType);
+	//a reference, the caller copies only if it needs to
 	return stafftype;
 }
 
+template <class Policy>
 bool staffmember::linkToHospital(const hospital& hosp)
 {
+	trace(staffmember::linkToHospital);
 	/*
 	Lock out the possibility of one-way linking, since
 	hospital calls this method after adding the patient
 	to its list
 	*/
-	if(!hosp.getStaff(name, surname).isValid())
+	if(hosp.getStaff(name, surname).getHandle() != self)
 	{
 		debug(staffmember::linkToHospital, one-way linking is forbidden);
 		return false;
@@ -180,7 +297,7 @@ bool staffmember::linkToHospital(const hospital& hosp)
 		return false;
 	}
 	//check if staff has a profession
-	else if(stafftype == "")
+	else if(Policy::professions && stafftype == "")
 	{
 		debug(staffmember::linkToHospital, this staffmember does not have a profession);
 		return false;
@@ -200,8 +317,12 @@ bool staffmember::linkToHospital(const hospital& hosp)
 	return true;
 }
 
+template bool staffmember::linkToHospital<checkedinput>(const hospital&);
+template bool staffmember::linkToHospital<trustedinput>(const hospital&);
+
 bool staffmember::unlinkFromHospital()
 {
+	trace(staffmember::unlinkFromHospital);
 	//check if a link was present
 	if(in_hospital == nullptr)
 	{
@@ -209,7 +330,7 @@ bool staffmember::unlinkFromHospital()
 		return false;
 	}
 	//check if hospital cleared the link already
-	else if(in_hospital -> getStaff(name, surname).isValid())
+	else if(in_hospital -> getStaff(name, surname).getHandle() == self)
 	{
 		debug(staffmember::unlinkFromHospital, link has to be terminated by hospital);
 		return false;
@@ -221,6 +342,7 @@ bool staffmember::unlinkFromHospital()
 
 hospital& staffmember::getHospital() const
 {
+	trace(staffmember::getHospital);
 	//return a valid reference to the hospital
 	if(in_hospital != nullptr) return *in_hospital;
 	//if invalid reference an empty hospital
@@ -229,8 +351,9 @@ hospital& staffmember::getHospital() const
 
 bool staffmember::linkToRoom(const room& rm)
 {
+	trace(staffmember::linkToRoom);
 	//first check if room added this staffmember
-	if(!(rm.getStaff() == *this))
+	if(rm.getStaff().getHandle() != self)
 	{
 		debug(staffmember::linkToRoom, one-way linking is forbidden);
 		return false;
@@ -259,13 +382,14 @@ bool staffmember::linkToRoom(const room& rm)
 
 bool staffmember::unlinkFromRoom()
 {
+	trace(staffmember::unlinkFromRoom);
 	//check if a link was present
 	if(in_room == nullptr)
 	{
 		debug(staffmember::unlinkFromRoom, a link is not present);
 		return false;
 	}
-	else if(in_room -> getStaff().isValid())
+	else if(in_room -> getStaff().getHandle() == self)
 	{
 		debug(staffmember::unlinkFromRoom, link has to be terminated by room);
 		return false;
@@ -277,6 +401,7 @@ bool staffmember::unlinkFromRoom()
 
 room& staffmember::getRoom() const
 {
+	trace(staffmember::getRoom);
 	//return a reference to the room
 	//if not pointing to nullptr
 	if(in_room != nullptr) return *in_room;
@@ -291,13 +416,14 @@ room& staffmember::getRoom() const
 */
 std::ostream& operator<< (std::ostream& str, const patient& ptn)
 {
+	trace(patient::operator<<);
 	str << "PATIENT: ";
 	//check if patient is valid
 	if(ptn.isValid())
 	{
-		str << ptn.name << " " << ptn.surname << ", " << ptn.age;
+		str << ptn.name << " " << ptn.surname << ", " << int(ptn.age);
 		//check for condition and print if applicable
-		if(ptn.condition != "") str << " | " << ptn.condition;
+		if(ptn.condition != 0) str << " | " << conditionName(ptn.condition);
 		else str << " | HEALTHY";
 		//print out room and hospital assignments if applicable
 		//uses getters for comparison to protect against nullptr access
@@ -311,21 +437,26 @@ std::ostream& operator<< (std::ostream& str, const patient& ptn)
 
 patient::~patient()
 {
+	trace(patient::~patient);
 	//unlink any link this patient has
 	if(in_room != nullptr)
 		in_room -> removePatient(*this);
 	if(in_hospital != nullptr)
 		in_hospital -> dischargePatient(*this);
+	//handles of this patient go stale
+	patientHandles().release(self);
 }
 
 bool patient::operator==(const patient& ref) const
 {
+	trace(patient::operator==);
 	//compare name strings
 	return (name == ref.name && surname == ref.surname);
 }
 
-patient::patient(std::string namestr, std::string surnamestr, int age)
+patient::patient(std::string_view namestr, std::string_view surnamestr, int agecount)
 {
+	trace(patient::patient);
 	//initialize the pointers to null for the checks
 	//to avoid segmentation faults
 	in_hospital = nullptr;
@@ -333,49 +464,147 @@ patient::patient(std::string namestr, std::string surnamestr, int age)
 	//fill the object with data
 	name = namestr;
 	surname = surnamestr;
+	condition = 0;
+	severity = 0;
 	//if method fails, set age to 0
-	if(!setAge(age)) age = 0;
+	if(!setAge(agecount)) age = 0;
+	self = patientHandles().acquire(this);
+}
+
+patient::patient(const patient& ref) : person(ref)
+{
+	trace(patient::patient);
+	//a copy does not inherit links of the original
+	condition = ref.condition;
+	severity = ref.severity;
+	in_hospital = nullptr;
+	in_room = nullptr;
+	self = patientHandles().acquire(this);
+}
+
+entityhandle patient::getHandle() const
+{
+	trace(patient::getHandle);
+	return self;
+}
+
+patient& patient::fromHandle(entityhandle handle)
+{
+	trace(patient::fromHandle);
+	patient* ptn = patientHandles().resolve(handle);
+	//stale handles reference an empty patient
+	if(ptn == nullptr) return empty_patient;
+	return *ptn;
 }
 
-bool patient::setName(std::string namestr, std::string surnamestr)
+template <class Policy>
+bool patient::setName(std::string_view namestr, std::string_view surnamestr)
 {
+	trace(patient::setName);
 	if(in_hospital != nullptr || in_room != nullptr)
 	{
 		debug(patient::setName, object is linked - you cannot change its name);
 		return false;
 	}
-	return person::setName(namestr, surnamestr);
+	return person::setName<Policy>(namestr, surnamestr);
 }
 
-bool patient::setCondition(std::string conditionstr)
+template bool patient::setName<checkedinput>(std::string_view, std::string_view);
+template bool patient::setName<trustedinput>(std::string_view, std::string_view);
+
+template <class Policy>
+bool patient::setCondition(std::string_view conditionstr)
 {
+	trace(patient::setCondition);
 	//check if condition is not an empty string
-	if(conditionstr == "")
+	if(!validText<Policy>(conditionstr))
 	{
 		debug(patient::setCondition, provided string is empty);
 		return false;
 	}
-	//assign string
-	else condition = conditionstr;
+	//keep hospital's derived data current
+	if(in_hospital != nullptr) in_hospital -> patientChanging(*this);
+	uint32_t previous = condition;
+	//store the ID, the condition decides the urgency
+	condition = conditionId(conditionstr);
+	severity = conditionSeverity(conditionstr);
+	if(in_hospital != nullptr)
+	{
+		in_hospital -> patientChanged(*this);
+		in_hospital -> conditionChanged(*this, previous);
+	}
 	return true;
 }
 
+template bool patient::setCondition<checkedinput>(std::string_view);
+template bool patient::setCondition<trustedinput>(std::string_view);
+
+template <class Policy>
+bool patient::setAge(int agecount)
+{
+	trace(patient::setAge);
+	//keep hospital's derived data current
+	if(in_hospital != nullptr) in_hospital -> patientChanging(*this);
+	bool result = person::setAge<Policy>(agecount);
+	if(in_hospital != nullptr) in_hospital -> patientChanged(*this);
+	return result;
+}
+
+template bool patient::setAge<checkedinput>(int);
+template bool patient::setAge<trustedinput>(int);
+
 void patient::removeCondition()
 {
-	//clear the string to default value
-	condition = "";
+	trace(patient::removeCondition);
+	if(in_hospital != nullptr) in_hospital -> patientChanging(*this);
+	uint32_t previous = condition;
+	//back to the healthy condition
+	condition = 0;
+	severity = 0;
+	if(in_hospital != nullptr)
+	{
+		in_hospital -> patientChanged(*this);
+		in_hospital -> conditionChanged(*this, previous);
+	}
+}
+
+bool patient::setSeverity(int level)
+{
+	trace(patient::setSeverity);
+	if(level < 0 || level > max_severity)
+	{
+		debug(patient::setSeverity, severity is out of range);
+		return false;
+	}
+	if(in_hospital != nullptr) in_hospital -> patientChanging(*this);
+	severity = level;
+	if(in_hospital != nullptr) in_hospital -> patientChanged(*this);
+	return true;
+}
+
+int patient::getSeverity() const
+{
+	trace(patient::getSeverity);
+	return severity;
+}
+
+const std::string& patient::getCondition() const
+{
+	trace(patient::getCondition);
+	//the registry keeps every condition string for good
+	return conditionName(condition);
 }
 
-std::string patient::getCondition() const
+uint32_t patient::getConditionId() const
 {
-	//return a string copy
 	return condition;
 }
 
 bool patient::linkToHospital(const hospital& hosp)
 {
+	trace(patient::linkToHospital);
 	//lock out one way linking
-	if(!(hosp.getPatient(name, surname) == *this))
+	if(hosp.getPatient(name, surname).getHandle() != self)
 	{
 		debug(patient::linkToHospital, one-way linking is forbidden);
 		return false;
@@ -403,6 +632,7 @@ bool patient::linkToHospital(const hospital& hosp)
 
 bool patient::unlinkFromHospital()
 {
+	trace(patient::unlinkFromHospital);
 	//check if a link was present
 	if(in_hospital == nullptr)
 	{
@@ -410,7 +640,7 @@ bool patient::unlinkFromHospital()
 		return false;
 	}
 	//check if hospital cleared the link already
-	else if(in_hospital -> getPatient(name, surname).isValid())
+	else if(in_hospital -> getPatient(name, surname).getHandle() == self)
 	{
 		debug(patient::unlinkFromHospital, link has to be terminated by hospital);
 		return false;
@@ -422,6 +652,7 @@ bool patient::unlinkFromHospital()
 
 hospital& patient::getHospital() const
 {
+	trace(patient::getHospital);
 	//return a valid reference to the hospital
 	if(in_hospital != nullptr) return *in_hospital;
 	//if invalid reference an empty hospital
@@ -430,8 +661,9 @@ hospital& patient::getHospital() const
 
 bool patient::linkToRoom(const room& rm)
 {
+	trace(patient::linkToRoom);
 	//lock out one way linking
-	if(!rm.getPatient(name, surname).isValid())
+	if(rm.getPatient(name, surname).getHandle() != self)
 	{
 		debug(patient::linkToRoom, one-way linking is forbidden);
 		return false;
@@ -452,14 +684,24 @@ bool patient::linkToRoom(const room& rm)
 	else
 	{
 		//link person to hospital
+		if(in_hospital != nullptr) in_hospital -> patientChanging(*this);
 		in_room = &((room&)rm);
 		debug(patient::linkToRoom, link confirmed);
+		if(in_hospital != nullptr)
+		{
+			in_hospital -> patientChanged(*this);
+			//a patient given a room no longer waits for one
+			in_hospital -> leaveWaitlist(*this);
+			in_hospital -> publishEvent(in_hospital -> handingoff == &rm ? event_patient_admitted : event_patient_roomed,
+				self, rm.getHandle());
+		}
 	}
 	return true;
 }
 
 bool patient::unlinkFromRoom()
 {
+	trace(patient::unlinkFromRoom);
 	//check if a link was present
 	if(in_room == nullptr)
 	{
@@ -467,18 +709,26 @@ bool patient::unlinkFromRoom()
 		return false;
 	}
 	//check if room cleared the link already
-	else if(in_room -> getPatient(name, surname).isValid())
+	else if(in_room -> getPatient(name, surname).getHandle() == self)
 	{
 		debug(patient::unlinkFromRoom, link has to be terminated by room);
 		return false;
 	}
 	//clear the link
-	else in_room = nullptr;
+	entityhandle left = in_room -> getHandle();
+	if(in_hospital != nullptr) in_hospital -> patientChanging(*this);
+	in_room = nullptr;
+	if(in_hospital != nullptr)
+	{
+		in_hospital -> patientChanged(*this);
+		in_hospital -> publishEvent(event_patient_unroomed, self, left);
+	}
 	return true;
 }
 
 room& patient::getRoom() const
 {
+	trace(patient::getRoom);
 	//return a reference to the room
 	//if not pointing to nullptr
 	if(in_room != nullptr) return *in_room;
@@ -494,6 +744,7 @@ room& patient::getRoom() const
 
 std::ostream& operator<<(std::ostream& str, const room& rm)
 {
+	trace(room::operator<<);
 	str << "ROOM: ";
 	if(rm.name == "")
 	str << "NULL";
@@ -515,41 +766,61 @@ std::ostream& operator<<(std::ostream& str, const room& rm)
 	return str;	
 }
 
-room::room(std::string rmnm)
+room::room(std::string rmnm, std::pmr::memory_resource* resource) : patients(resource)
 {
+	trace(room::room);
 	//initialise pointers
 	assignee = nullptr;
 	in_hospital = nullptr;
+	capacity = 0;
 	//set some basic information
-	name = rmnm;
+	name = std::move(rmnm);
+	self = roomHandles().acquire(this);
+}
+
+room::room(const room& ref) : patients(ref.patients.resource())
+{
+	trace(room::room);
+	//a copy starts empty and unlinked, with the same capacity
+	assignee = nullptr;
+	in_hospital = nullptr;
+	capacity = ref.capacity;
+	name = ref.name;
+	self = roomHandles().acquire(this);
+}
+
+entityhandle room::getHandle() const
+{
+	trace(room::getHandle);
+	return self;
+}
+
+room& room::fromHandle(entityhandle handle)
+{
+	trace(room::fromHandle);
+	room* rm = roomHandles().resolve(handle);
+	//stale handles reference an empty room
+	if(rm == nullptr) return empty_room;
+	return *rm;
 }
 
 room::~room()
 {
+	trace(room::~room);
 	//clear links of objects to the room
 	if(in_hospital != nullptr)
 		in_hospital -> removeRoom(*this);
-	if(!patients.empty())
-	{
-		patient* ptemp;
-		auto pt = patients.begin();
-		while(pt != patients.end())
-		{
-			//save for unlinkage
-			ptemp = *pt; 
-			//go to next
-			pt++;
-			//remove
-			removePatient(*ptemp);
-		}
-	}
+	while(!patients.empty() && removePatient(**patients.begin()));
 	if(assignee != nullptr)
 		unlinkStaff();
 	
+	//handles of this room go stale
+	roomHandles().release(self);
 }
 
 bool room::setName(std::string rmnm)
 {
+	trace(room::setName);
 	//check if not empty
 	if(rmnm == "")
 	{
@@ -563,18 +834,20 @@ bool room::setName(std::string rmnm)
 		return false;
 	}
 	//assign the string
-	else name = rmnm;
+	else name = std::move(rmnm);
 	return true;
 }
 
-std::string room::getName() const
+const std::string& room::getName() const
 {
+	trace(room::getName);
 	//return a room name
 	return name;
 }
 
 bool room::addPatient(patient& ptn)
 {
+	trace(room::addPatient);
 	//check for room validity
 	if(!isValid())
 	{
@@ -587,16 +860,22 @@ bool room::addPatient(patient& ptn)
 		debug(room::addPatient, this patient is already present);
 		return false;
 	}
+	//check for a free bed
+	else if(isFull())
+	{
+		debug(room::addPatient, this room is full);
+		return false;
+	}
 	//create mutual relationship, patient verified
 	else
 	{
 		//required for patient to detect two way link
-		patients.push_back(&ptn);
+		patients.insert(ptn);
 		//if for any reason the link fails, notify and exit
 		if(!ptn.linkToRoom(*this))
 		{
 			debug(room::addPatient, the patient refused to link);
-			patients.remove(&ptn);
+			patients.erase(ptn);
 			return false;
 		}
 	}
@@ -605,8 +884,9 @@ bool room::addPatient(patient& ptn)
 
 bool room::removePatient(patient& ptn)
 {
+	trace(room::removePatient);
 	//search for the specified patient in the room
-	if( getPatient(ptn.getName(), ptn.getSurname()).getName() == "")
+	if(!patients.contains(personkey::of(ptn)))
 	{
 		debug(room::removePatient, this patient is not present);
 		return false;
@@ -614,14 +894,40 @@ bool room::removePatient(patient& ptn)
 	//match found
 	else
 	{
-		patients.remove(&ptn);
+		patients.erase(ptn);
 		ptn.unlinkFromRoom();
+		//hand the bed over to a waiting patient
+		if(in_hospital != nullptr) in_hospital -> roomFreed(*this, &ptn);
 	}
 	return true;
 }
 
+void room::setCapacity(std::size_t beds)
+{
+	trace(room::setCapacity);
+	capacity = beds;
+	//new beds go to waiting patients
+	if(in_hospital != nullptr) in_hospital -> roomFreed(*this, nullptr);
+}
+
+std::size_t room::getCapacity() const
+{
+	return capacity;
+}
+
+std::size_t room::getPatientCount() const
+{
+	return patients.size();
+}
+
+bool room::isFull() const
+{
+	return capacity != 0 && patients.size() >= capacity;
+}
+
 void room::printPatients() const
 {
+	trace(room::printPatients);
 	std::cout << "ROOM: '" << name << "' "; 
 	//empty list optimisation
 	if(patients.empty())
@@ -638,24 +944,19 @@ void room::printPatients() const
 	}
 }
 
-patient& room::getPatient(std::string nmstr, std::string snstr) const
+patient& room::getPatient(std::string_view nmstr, std::string_view snstr) const
 {
-	//empty list optimisation
-	if(patients.empty()) return empty_patient;
-	//perform a search through the list
-	for(patient* p : patients)
-	{
-		//check element's name and surname for match
-		if((*p).getName() == nmstr && (*p).getSurname() == snstr)
-		//return if match found 
-		return *p;
-	}
+	trace(room::getPatient);
+	patient* found = patients.find({nmstr, snstr});
 	//search did not find any match
-	return empty_patient;
+	if(found == nullptr) return empty_patient;
+	//return if match found
+	return *found;
 }
 
 bool room::linkStaff(staffmember& stm)
 {
+	trace(room::linkStaff);
 	//check for room validity
 	if(!isValid())
 	{
@@ -671,21 +972,29 @@ bool room::linkStaff(staffmember& stm)
 	//add a verified staff member
 	else
 	{
+		//keep hospital's derived data current
+		if(in_hospital != nullptr) in_hospital -> roomChanging(*this);
 		//required for staff to detect two way link
 		assignee = &stm;
 		//if for any reason the link fails, notify and exit
-		if(!stm.linkToRoom(*this))
+		bool linked = stm.linkToRoom(*this);
+		if(!linked)
 		{
 			debug(room::linkStaff, the staffmember refused to link);
 			assignee = nullptr;
-			return false;
 		}
+		if(in_hospital != nullptr)
+		{
+			in_hospital -> roomChanged(*this);
+			if(linked) in_hospital -> publishEvent(event_staff_assigned, stm.getHandle(), self);
+		}
+		return linked;
 	}
-	return true;
 }
 
 bool room::unlinkStaff()
 {
+	trace(room::unlinkStaff);
 	//if there is no staff return false
 	if(assignee == nullptr)
 	{
@@ -696,15 +1005,22 @@ bool room::unlinkStaff()
 	else
 	{
 		staffmember* temp = assignee;
+		if(in_hospital != nullptr) in_hospital -> roomChanging(*this);
 		//required for staff to detect both way unlink
 		assignee = nullptr;
 		temp -> unlinkFromRoom();
+		if(in_hospital != nullptr)
+		{
+			in_hospital -> roomChanged(*this);
+			in_hospital -> publishEvent(event_staff_unassigned, temp -> getHandle(), self);
+		}
 	}
 	return true;
 }
 
 staffmember& room::getStaff() const
 {
+	trace(room::getStaff);
 	//check if staff pointer is null
 	if(assignee == nullptr) return empty_staff;
 	//if it is not return a staff reference
@@ -713,8 +1029,9 @@ staffmember& room::getStaff() const
 
 bool room::linkToHospital(const hospital& hosp)
 {
+	trace(room::linkToHospital);
 	//forbid one-way linking
-	if(!hosp.getRoom(name).isValid())
+	if(hosp.getRoom(name).getHandle() != self)
 	{
 		debug(room::linkToHospital, one-way linking is forbidden);
 		return false;
@@ -743,6 +1060,7 @@ bool room::linkToHospital(const hospital& hosp)
 
 bool room::unlinkFromHospital()
 {
+	trace(room::unlinkFromHospital);
 	//if room is not linked return false
 	if(in_hospital == nullptr)
 	{
@@ -750,7 +1068,7 @@ bool room::unlinkFromHospital()
 		return false;
 	}
 	//check if hospital unlinked first
-	if(in_hospital -> getRoom(name).isValid())
+	if(in_hospital -> getRoom(name).getHandle() == self)
 	{
 		debug(room::unlinkFromHospital, link has to be terminated by hospital);
 		return false;
@@ -762,6 +1080,7 @@ bool room::unlinkFromHospital()
 
 hospital& room::getHospital() const
 {
+	trace(room::getHospital);
 	//check if assignment is empty, return empty if it is
 	if(in_hospital == nullptr) return empty_hospital;
 	//if not return a reference
@@ -770,6 +1089,7 @@ hospital& room::getHospital() const
 
 bool room::isValid() const
 {
+	trace(room::isValid);
 	//check if name is empty
 	if(name != "") return true;
 	else return false;
@@ -783,6 +1103,7 @@ bool room::isValid() const
 
 std::ostream& operator<<(std::ostream& str, const hospital& hosp)
 {
+	trace(hospital::operator<<);
 	str << "HOSPITAL: ";
 	if(hosp.name != "")
 	str << hosp.name << "";
@@ -791,62 +1112,79 @@ std::ostream& operator<<(std::ostream& str, const hospital& hosp)
 	return str;
 }
 
-hospital::hospital(std::string hsnm)
+hospital::hospital(std::string hsnm, std::pmr::memory_resource* resource) : hospital(std::move(hsnm), hospitallimits(), resource)
 {
-	//set a name
-	name = hsnm;
 }
 
-hospital::~hospital()
+hospital::hospital(std::string hsnm, const hospitallimits& lims) : hospital(std::move(hsnm), lims, std::pmr::get_default_resource())
 {
-	//unlink every object associated with this hospital
-	if(!roomlist.empty())
-	{
-		room* rtemp;
-		auto rm = roomlist.begin();
-		while(rm != roomlist.end())
-		{
-			//save for unlinkage
-			rtemp = *rm;
-			//advance
-			rm++;
-			//remove linkage
-			removeRoom(*rtemp);
-		}
-	}
-	if(!stafflist.empty())
+}
+
+hospital::hospital(std::string hsnm, const hospitallimits& lims, std::pmr::memory_resource* resource) :
+	arena(isLimited(lims) ? std::make_unique<fixedarena>(arenaBytes(lims)) : nullptr), limits(lims),
+	memory(arena != nullptr ? arena.get() : resource), counts(&memory), triage(&memory),
+	patientnames(&memory), staffnames(&memory), patientsurnames(&memory), staffsurnames(&memory),
+	roomwaits(&memory), conditionwaits(&memory), waitingon(&memory),
+	stafflist(&memory), roomlist(&memory), patients(&memory)
+{
+	trace(hospital::hospital);
+	//set a name
+	name = std::move(hsnm);
+	columns = nullptr;
+	feed = nullptr;
+	arrivals = 0;
+	handingoff = nullptr;
+	self = hospitalHandles().acquire(this);
+	//the indexes never rehash below the limits
+	if(limits.patients != 0)
 	{
-		staffmember* stemp;
-		auto sm = stafflist.begin();
-		while(sm != stafflist.end())
-		{
-			//save for unlinkage
-			stemp = *sm;
-			//advance
-			sm++;
-			//remove linkage
-			dismissStaff(*stemp);
-		}
+		patients.reserve(limits.patients);
+		waitingon.reserve(limits.patients);
+		patientnames.reserve(limits.patients);
 	}
-	if(!patients.empty())
+	if(limits.staff != 0)
 	{
-		patient* ptemp;
-		auto pt = patients.begin();
-		while(pt != patients.end())
-		{
-			//save for unlinkage
-			ptemp = *pt;
-			//advance
-			pt++;
-			//remove linkage
-			dischargePatient(*ptemp);
-		}
+		stafflist.reserve(limits.staff);
+		staffnames.reserve(limits.staff);
 	}
+	if(limits.rooms != 0) roomlist.reserve(limits.rooms);
+}
+
+hospital::hospital(const hospital& ref) : hospital(ref.name, ref.limits, ref.memory.upstream())
+{
+	//a copy starts without any rooms, staff or patients
+}
+
+entityhandle hospital::getHandle() const
+{
+	trace(hospital::getHandle);
+	return self;
+}
+
+hospital& hospital::fromHandle(entityhandle handle)
+{
+	trace(hospital::fromHandle);
+	hospital* hosp = hospitalHandles().resolve(handle);
+	//stale handles reference an empty hospital
+	if(hosp == nullptr) return empty_hospital;
+	return *hosp;
+}
+
+hospital::~hospital()
+{
+	trace(hospital::~hospital);
+	//unlink every object associated with this hospital, first to last
+	while(!roomlist.empty() && removeRoom(**roomlist.begin()));
+	while(!stafflist.empty() && dismissStaff(**stafflist.begin()));
+	while(!patients.empty() && dischargePatient(**patients.begin()));
 	
+	//handles of this hospital go stale
+	hospitalHandles().release(self);
 }
 
 bool hospital::setName(std::string hsnm)
 {
+	trace(hospital::setName);
 	//check if the name is not empty
 	if(hsnm == "")
 	{
@@ -854,17 +1192,19 @@ bool hospital::setName(std::string hsnm)
 		return false;
 	}
 	//set values if name is correct
-	else name = hsnm;
+	else name = std::move(hsnm);
 	return true;
 }
 
-std::string hospital::getName() const
+const std::string& hospital::getName() const
 {
+	trace(hospital::getName);
 	return name;
 }
 
 bool hospital::registerPatient(patient& ptn)
 {
+	trace(hospital::registerPatient);
 	//check if hospital is valid
 	if(!isValid())
 	{
@@ -877,31 +1217,53 @@ bool hospital::registerPatient(patient& ptn)
 		debug(hospital::registerPatient, this patient is already registered);
 		return false;
 	}
+	else if(limits.patients != 0 && patients.size() >= limits.patients)
+	{
+		debug(hospital::registerPatient, this hospital is full);
+		return false;
+	}
 	//patient can be added properly
 	else
 	{
 		//for the patient to detect two-way link
-		patients.push_back(&ptn);
+		patients.insert(ptn);
 		//if for any reason link fails, notify and exit
 		if(!ptn.linkToHospital(*this))
 		{
 			debug(hospital::registerPatient, the patient refused to link);
-			patients.remove(&ptn);
+			patients.erase(ptn);
 			return false;
-		} 
+		}
+		counts.addPatient(ptn);
+		patientnames.insert(fullName(ptn.getName(), ptn.getSurname(), &memory), ptn.getHandle().pack());
+		patientsurnames.insert(ptn.getSurname(), ptn.getHandle().pack());
+		if(columns != nullptr) columns -> insert(ptn);
+		publishEvent(event_patient_registered, ptn.getHandle(), entityhandle());
 	}
 	return true;
 }
 
 bool hospital::dischargePatient(patient& ptn)
 {
-	//temporary value to search once
-	patient& pat = getPatient(ptn.getName(), ptn.getSurname());
+	trace(hospital::dischargePatient);
+	//search once
+	patient* found = patients.find(personkey::of(ptn));
 	//check if such patient is on the list
-	if(pat.isValid())
+	if(found != nullptr)
 	{
+		patient& pat = *found;
+		//free the bed first, so a waiting patient can take it
+		room& bed = pat.getRoom();
+		if(bed.isValid()) bed.removePatient(pat);
+		leaveWaitlist(pat);
 		//remove
-		patients.remove(&pat);
+		patients.erase(pat);
+		counts.removePatient(pat);
+		patientnames.erase(pat.getHandle().pack());
+		patientsurnames.erase(pat.getHandle().pack());
+		triage.erase(pat);
+		if(columns != nullptr) columns -> erase(pat);
+		publishEvent(event_patient_discharged, pat.getHandle(), entityhandle());
 		pat.unlinkFromHospital();
 		return true;
 	}
@@ -911,6 +1273,7 @@ bool hospital::dischargePatient(patient& ptn)
 
 void hospital::printPatients() const
 {
+	trace(hospital::printPatients);
 	//display list header
 	std::cout << "HOSPITAL: '" << name << "' "; 
 	//empty list optimisation
@@ -928,24 +1291,20 @@ void hospital::printPatients() const
 	}
 }
 
-patient& hospital::getPatient(std::string nmstr, std::string snstr) const
+patient& hospital::getPatient(std::string_view nmstr, std::string_view snstr) const
 {
-	//empty list optimisation
-	if(patients.empty()) return empty_patient;
-	//perform a search through the list
-	for(patient* p : patients)
-	{
-		//check element's name and surname for match
-		if((*p).getName() == nmstr && (*p).getSurname() == snstr)
-		//return if match found 
-		return *p;
-	}
+	trace(hospital::getPatient);
+	patient* found = patients.find({nmstr, snstr});
 	//search did not find any match
-	return empty_patient;
+	if(found == nullptr) return empty_patient;
+	//return if match found
+	return *found;
 }
 
+template <class Policy>
 bool hospital::employStaff(staffmember& stm)
 {
+	trace(hospital::employStaff);
 	//check if hospital has a name
 	if(!isValid())
 	{
@@ -958,28 +1317,43 @@ bool hospital::employStaff(staffmember& stm)
 		debug(hospital::employStaff, this staff member is employed already);
 		return false;
 	}
+	else if(limits.staff != 0 && stafflist.size() >= limits.staff)
+	{
+		debug(hospital::employStaff, this hospital employs all the staff it can);
+		return false;
+	}
 	//staff is now valid to employ
 	else
 	{
-		stafflist.push_back(&stm);
-		if(!stm.linkToHospital(*this))
+		stafflist.insert(stm);
+		if(!stm.linkToHospital<Policy>(*this))
 		{
 			debug(hospital::employStaff, the staffmember refused to link);
-			stafflist.remove(&stm);
+			stafflist.erase(stm);
 			return false;
 		}
+		staffnames.insert(fullName(stm.getName(), stm.getSurname(), &memory), stm.getHandle().pack());
+		staffsurnames.insert(stm.getSurname(), stm.getHandle().pack());
+		publishEvent(event_staff_employed, stm.getHandle(), entityhandle());
 	}
 	return true;
 }
 
+template bool hospital::employStaff<checkedinput>(staffmember&);
+template bool hospital::employStaff<trustedinput>(staffmember&);
+
 bool hospital::dismissStaff(staffmember& stm)
 {
-	//temp value for one search only
-	staffmember& staff = getStaff(stm.getName(), stm.getSurname());
+	trace(hospital::dismissStaff);
 	//check if search returned valid staff
-	if(staff.isValid())
+	if(stafflist.contains(personkey::of(stm)))
 	{
-		stafflist.remove(&stm);
+		if(stafflist.erase(stm))
+		{
+			staffnames.erase(stm.getHandle().pack());
+			staffsurnames.erase(stm.getHandle().pack());
+			publishEvent(event_staff_dismissed, stm.getHandle(), entityhandle());
+		}
 		stm.unlinkFromHospital();
 		return true;
 	}
@@ -989,6 +1363,7 @@ bool hospital::dismissStaff(staffmember& stm)
 
 void hospital::printStaff() const
 {
+	trace(hospital::printStaff);
 	//display list header
 	std::cout << "HOSPITAL: '" << name << "' "; 
 	//empty list optimisation
@@ -1006,22 +1381,18 @@ void hospital::printStaff() const
 	}
 }
 
-staffmember& hospital::getStaff(std::string namestr, std::string surnamestr) const
+staffmember& hospital::getStaff(std::string_view namestr, std::string_view surnamestr) const
 {
-	//empty list optimisation
-	if(stafflist.empty()) return empty_staff;
-	//search for the staffmember
-	for(staffmember* s : stafflist)
-	{
-		if((*s).getName() == namestr && (*s).getSurname() == surnamestr)
-		return *s; 
-	}
+	trace(hospital::getStaff);
+	staffmember* found = stafflist.find({namestr, surnamestr});
 	//search did not succeed
-	return empty_staff;
+	if(found == nullptr) return empty_staff;
+	return *found;
 }
 
 bool hospital::addRoom(room& rm)
 {
+	trace(hospital::addRoom);
 	//unnamed hospital
 	if(!isValid())
 	{
@@ -1034,28 +1405,45 @@ bool hospital::addRoom(room& rm)
 		debug(hospital::addRoom, this room already exists);
 		return false;
 	}
+	if(limits.rooms != 0 && roomlist.size() >= limits.rooms)
+	{
+		debug(hospital::addRoom, this hospital has all the rooms it can);
+		return false;
+	}
 	//hospital can be validly added
 	else
 	{
-		roomlist.push_back(&rm);
+		roomlist.insert(rm);
 		if(!rm.linkToHospital(*this))
 		{
 			debug(hospital::addRoom, the room refused to link);
-			roomlist.remove(&rm);
+			roomlist.erase(rm);
 			return false;
 		}
+		counts.addRoom(rm);
+		publishEvent(event_room_added, rm.getHandle(), entityhandle());
 	}
 	return true;
 }
 
 bool hospital::removeRoom(room& rm)
 {
-	//temp value for one search only
-	room& roomref = getRoom(rm.getName());
+	trace(hospital::removeRoom);
 	//check if search returned valid room
-	if(roomref.isValid())
+	if(roomlist.contains(namekey::of(rm)))
 	{
-		roomlist.remove(&rm);
+		if(roomlist.erase(rm))
+		{
+			counts.removeRoom(rm);
+			//patients waiting for this room stop waiting
+			auto waits = roomwaits.find(rm.getHandle().index);
+			if(waits != roomwaits.end())
+			{
+				while(patient* ptn = waits -> second.pop()) waitingon.erase(ptn -> getHandle().index);
+				roomwaits.erase(waits);
+			}
+			publishEvent(event_room_removed, rm.getHandle(), entityhandle());
+		}
 		rm.unlinkFromHospital();
 		return true;
 	}
@@ -1065,6 +1453,7 @@ bool hospital::removeRoom(room& rm)
 
 void hospital::printRooms() const
 {
+	trace(hospital::printRooms);
 	//display list header
 	std::cout << "HOSPITAL: '" << name << "' "; 
 	//empty list optimisation
@@ -1082,24 +1471,18 @@ void hospital::printRooms() const
 	}
 }
 
-room& hospital::getRoom(std::string nmstr) const
+room& hospital::getRoom(std::string_view nmstr) const
 {
-	//empty list optimisation
-	if(roomlist.empty()) return empty_room;
-	//perform a search through the list
-	for(room* r : roomlist)
-	{
-		//check element's name and surname for match
-		if((*r).getName() == nmstr)
-		//return if match found 
-		return *r;
-	}
+	trace(hospital::getRoom);
+	room* found = roomlist.find({nmstr});
 	//search did not find any match
-	return empty_room;
+	if(found == nullptr) return empty_room;
+	return *found;
 }
 
 void hospital::printStatus() const
 {
+	trace(hospital::printStatus);
 	std::cout << "HOSPITAL: '" << name << "' HAS " << stafflist.size()
 	<< " STAFF, " << patients.size();
 	if(patients.size() == 1) std::cout << " PATIENT, ";
@@ -1110,8 +1493,326 @@ void hospital::printStatus() const
 	std::cout << std::endl;
 }
 
+const patientregistry& hospital::getPatientList() const
+{
+	trace(hospital::getPatientList);
+	return patients;
+}
+
+const staffregistry& hospital::getStaffList() const
+{
+	trace(hospital::getStaffList);
+	return stafflist;
+}
+
+const roomregistry& hospital::getRoomList() const
+{
+	trace(hospital::getRoomList);
+	return roomlist;
+}
+
+bool hospital::attachColumns(patientcolumns& cols)
+{
+	trace(hospital::attachColumns);
+	if(columns != nullptr)
+	{
+		debug(hospital::attachColumns, a store is already attached);
+		return false;
+	}
+	columns = &cols;
+	//mirror every patient registered so far
+	for(patient* p : patients) columns -> insert(*p);
+	return true;
+}
+
+bool hospital::detachColumns()
+{
+	trace(hospital::detachColumns);
+	if(columns == nullptr)
+	{
+		debug(hospital::detachColumns, no store is attached);
+		return false;
+	}
+	for(patient* p : patients) columns -> erase(*p);
+	columns = nullptr;
+	return true;
+}
+
+bool hospital::attachFeed(eventfeed& fd)
+{
+	trace(hospital::attachFeed);
+	if(feed != nullptr)
+	{
+		debug(hospital::attachFeed, a feed is already attached);
+		return false;
+	}
+	feed = &fd;
+	return true;
+}
+
+bool hospital::detachFeed()
+{
+	trace(hospital::detachFeed);
+	if(feed == nullptr)
+	{
+		debug(hospital::detachFeed, no feed is attached);
+		return false;
+	}
+	feed = nullptr;
+	return true;
+}
+
+void hospital::publishEvent(eventkind kind, entityhandle subject, entityhandle target)
+{
+	if(feed != nullptr) feed -> publish(kind, self, subject, target);
+}
+
+const census& hospital::getCensus() const
+{
+	trace(hospital::getCensus);
+	return counts;
+}
+
+const countingresource& hospital::getMemory() const
+{
+	trace(hospital::getMemory);
+	return memory;
+}
+
+const hospitallimits& hospital::getLimits() const
+{
+	trace(hospital::getLimits);
+	return limits;
+}
+
+void hospital::reservePatients(std::size_t count)
+{
+	trace(hospital::reservePatients);
+	patients.reserve(count);
+}
+
+bool hospital::admitToTriage(patient& ptn)
+{
+	trace(hospital::admitToTriage);
+	if(ptn.getHospital().getHandle() != self)
+	{
+		debug(hospital::admitToTriage, this patient is not registered here);
+		return false;
+	}
+	if(!triage.push(ptn, arrivals))
+	{
+		debug(hospital::admitToTriage, this patient is already waiting);
+		return false;
+	}
+	arrivals++;
+	return true;
+}
+
+patient& hospital::nextPatient()
+{
+	trace(hospital::nextPatient);
+	patient* next = triage.pop();
+	if(next == nullptr) return empty_patient;
+	return *next;
+}
+
+patient& hospital::peekNextPatient() const
+{
+	trace(hospital::peekNextPatient);
+	patient* next = triage.top();
+	if(next == nullptr) return empty_patient;
+	return *next;
+}
+
+bool hospital::leaveTriage(patient& ptn)
+{
+	trace(hospital::leaveTriage);
+	return triage.erase(ptn);
+}
+
+std::size_t hospital::waitingCount() const
+{
+	trace(hospital::waitingCount);
+	return triage.size();
+}
+
+std::vector<patient*> hospital::findPatients(std::string_view query, std::size_t count, int maxdistance) const
+{
+	trace(hospital::findPatients);
+	std::vector<patient*> found;
+	for(const fuzzymatch& m : patientnames.search(query, count, maxdistance))
+		found.push_back(&patient::fromHandle(entityhandle::unpack(m.value)));
+	return found;
+}
+
+std::vector<staffmember*> hospital::findStaff(std::string_view query, std::size_t count, int maxdistance) const
+{
+	trace(hospital::findStaff);
+	std::vector<staffmember*> found;
+	for(const fuzzymatch& m : staffnames.search(query, count, maxdistance))
+		found.push_back(&staffmember::fromHandle(entityhandle::unpack(m.value)));
+	return found;
+}
+
+std::vector<patient*> hospital::completePatients(std::string_view prefix, std::size_t count) const
+{
+	trace(hospital::completePatients);
+	std::vector<patient*> found;
+	for(uint64_t value : patientsurnames.complete(prefix, count))
+		found.push_back(&patient::fromHandle(entityhandle::unpack(value)));
+	return found;
+}
+
+std::vector<staffmember*> hospital::completeStaff(std::string_view prefix, std::size_t count) const
+{
+	trace(hospital::completeStaff);
+	std::vector<staffmember*> found;
+	for(uint64_t value : staffsurnames.complete(prefix, count))
+		found.push_back(&staffmember::fromHandle(entityhandle::unpack(value)));
+	return found;
+}
+
+std::size_t hospital::surnameIndexMemory() const
+{
+	trace(hospital::surnameIndexMemory);
+	return patientsurnames.memoryUsage() + staffsurnames.memoryUsage();
+}
+
+bool hospital::waitForRoom(patient& ptn, room& rm)
+{
+	trace(hospital::waitForRoom);
+	if(ptn.getHospital().getHandle() != self || rm.getHospital().getHandle() != self)
+	{
+		debug(hospital::waitForRoom, the patient or the room is not here);
+		return false;
+	}
+	if(ptn.getRoom().isValid() || waitingon.count(ptn.getHandle().index) != 0)
+	{
+		debug(hospital::waitForRoom, this patient has a room or is waiting);
+		return false;
+	}
+	//no need to wait for a free bed
+	if(!rm.isFull()) return rm.addPatient(ptn);
+	waitlist& waits = roomwaits.try_emplace(rm.getHandle().index, &memory).first -> second;
+	waits.push(ptn);
+	waitingon[ptn.getHandle().index] = &waits;
+	publishEvent(event_patient_waitlisted, ptn.getHandle(), rm.getHandle());
+	return true;
+}
+
+bool hospital::waitForBed(patient& ptn)
+{
+	trace(hospital::waitForBed);
+	if(ptn.getHospital().getHandle() != self || ptn.getConditionId() == 0)
+	{
+		debug(hospital::waitForBed, the patient is not here or healthy);
+		return false;
+	}
+	if(ptn.getRoom().isValid() || waitingon.count(ptn.getHandle().index) != 0)
+	{
+		debug(hospital::waitForBed, this patient has a room or is waiting);
+		return false;
+	}
+	waitlist& waits = conditionwaits.try_emplace(ptn.getConditionId(), &memory).first -> second;
+	waits.push(ptn);
+	waitingon[ptn.getHandle().index] = &waits;
+	publishEvent(event_patient_waitlisted, ptn.getHandle(), entityhandle());
+	return true;
+}
+
+bool hospital::leaveWaitlist(patient& ptn)
+{
+	trace(hospital::leaveWaitlist);
+	auto found = waitingon.find(ptn.getHandle().index);
+	if(found == waitingon.end() || !found -> second -> erase(ptn)) return false;
+	waitingon.erase(found);
+	return true;
+}
+
+std::size_t hospital::waitlistLength(const room& rm) const
+{
+	trace(hospital::waitlistLength);
+	auto found = roomwaits.find(rm.getHandle().index);
+	if(found == roomwaits.end() || rm.getHospital().getHandle() != self) return 0;
+	return found -> second.size();
+}
+
+std::size_t hospital::waitlistLength(std::string_view conditionstr) const
+{
+	trace(hospital::waitlistLength);
+	auto found = conditionwaits.find(conditionId(conditionstr));
+	if(found == conditionwaits.end()) return 0;
+	return found -> second.size();
+}
+
+void hospital::roomFreed(room& rm, const patient* left)
+{
+	//nothing to hand over most of the time
+	if(waitingon.empty()) return;
+	auto own = roomwaits.find(rm.getHandle().index);
+	auto same = conditionwaits.end();
+	if(left != nullptr && left -> getConditionId() != 0) same = conditionwaits.find(left -> getConditionId());
+	//a room without a limit is never full, so it takes the one bed left
+	//behind, or its own waitlist when it just lost its limit
+	std::size_t beds = rm.getCapacity() != 0 ? rm.getCapacity() - std::min(rm.getCapacity(), rm.getPatientCount()) :
+		left != nullptr ? 1 : SIZE_MAX;
+	while(beds > 0 && !rm.isFull())
+	{
+		waitlist* waits = nullptr;
+		if(own != roomwaits.end() && !own -> second.empty()) waits = &own -> second;
+		else if(same != conditionwaits.end() && !same -> second.empty()) waits = &same -> second;
+		else return;
+		patient* next = waits -> pop();
+		waitingon.erase(next -> getHandle().index);
+		//a patient refused by the room is dropped, the next one is tried
+		handingoff = &rm;
+		if(rm.addPatient(*next)) beds--;
+		else debug(hospital::roomFreed, a waiting patient was refused);
+		handingoff = nullptr;
+	}
+}
+
+void hospital::conditionChanged(patient& ptn, uint32_t previous)
+{
+	auto found = waitingon.find(ptn.getHandle().index);
+	if(found == waitingon.end() || previous == ptn.getConditionId()) return;
+	//only the waitlist of a condition depends on it, room waitlists stay
+	auto old = conditionwaits.find(previous);
+	if(old == conditionwaits.end() || found -> second != &old -> second) return;
+	old -> second.erase(ptn);
+	waitingon.erase(found);
+	//a patient who got well no longer waits for a bed
+	if(ptn.getConditionId() == 0) return;
+	waitlist& waits = conditionwaits.try_emplace(ptn.getConditionId(), &memory).first -> second;
+	waits.push(ptn);
+	waitingon[ptn.getHandle().index] = &waits;
+}
+
+void hospital::patientChanging(const patient& ptn)
+{
+	counts.removePatient(ptn);
+}
+
+void hospital::patientChanged(const patient& ptn)
+{
+	counts.addPatient(ptn);
+	triage.update(ptn);
+	if(columns != nullptr) columns -> update(ptn);
+}
+
+void hospital::roomChanging(const room& rm)
+{
+	counts.removeRoom(rm);
+}
+
+void hospital::roomChanged(const room& rm)
+{
+	counts.addRoom(rm);
+}
+
 bool hospital::isValid() const
 {
+	trace(hospital::isValid);
 	//check if name is empty
 	if(name != "") return true;
 	else return false;
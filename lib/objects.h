@@ -9,14 +9,33 @@
 
 #include <iostream>
 #include <string>
-#include <list>
+#include <string_view>
 #include <iterator>
+#include <memory_resource>
+#include <unordered_map>
+#include "handles.h"
+#include "memory.h"
+#include "registry.h"
+#include "shortstring.h"
+#include "columns.h"
+#include "census.h"
+#include "events.h"
+#include "triage.h"
+#include "waitlist.h"
+#include "fuzzy.h"
+#include "trie.h"
+#include "validation.h"
+#include <vector>
 
 /*
 Comment the define below to disable
-debug message feature.
+debug message feature. Building with
+-Dno_debug_msg (as 'make bench' does)
+also disables it.
 */
+#ifndef no_debug_msg
 #define debug_msg
+#endif
 
 class person;
 class staffmember;
@@ -24,6 +43,24 @@ class patient;
 class room;
 class hospital;
 
+/*
+Registries of the hospitals and rooms, keyed by name. All
+use the list policy, which keeps the order of addition.
+Building with -Dfiltered_registries puts a filter in front
+of the patient and staff ones (see filteredpolicy), which
+pays off when most lookups are duplicate checks of new
+people. Rooms are few and mostly found, so never filtered.
+*/
+#ifdef filtered_registries
+using personpolicy = filteredpolicy<listpolicy>;
+#else
+using personpolicy = listpolicy;
+#endif
+using patientregistry = registry<patient, personkey, personpolicy>;
+using staffregistry = registry<staffmember, personkey, personpolicy>;
+using roomregistry = registry<room, namekey>;
+using roompatientregistry = registry<patient, personkey>;
+
 /*
 Base class used for inheritance for
 patient and staffmember classes.
@@ -41,20 +78,27 @@ public:
 	the person in question. Returns false without changes
 	if:
 	- name and/or surname are empty strings
+	Every setter takes a validation policy (see
+	validation.h), checkedinput and trustedinput are
+	available.
 	*/
-	bool setName(std::string namestr, std::string surnamestr); //DONE
+	template <class Policy = defaultvalidation>
+	bool setName(std::string_view namestr, std::string_view surnamestr); //DONE
 	/*
-	Returns a name string copy.
+	Returns a view of the name. It stays valid until
+	the name changes or the person is destroyed.
 	*/
-	std::string getName() const; //DONE
+	std::string_view getName() const; //DONE
 	/*
-	Returns a string containing surname.
+	Returns a view of the surname, see getName.
 	*/
-	std::string getSurname() const; //DONE
+	std::string_view getSurname() const; //DONE
 	/*
 	Sets the age. Fails if age is outside the
-	[0;200] range.
+	[0;200] range. A policy that does not check
+	ranges clamps it to [0;255] instead.
 	*/
+	template <class Policy = defaultvalidation>
 	bool setAge(int agecount); //DONE
 	/*
 	Returns an integer copy of person's age.
@@ -68,9 +112,10 @@ public:
 	bool isValid() const; //DONE
 	
 protected:
-	std::string name;
-	std::string surname;
-	int age;
+	//names of up to 15 characters take no heap memory
+	shortstring name;
+	shortstring surname;
+	uint8_t age;
 
 };
 
@@ -102,7 +147,24 @@ public:
 	Initialises pointers to null, sets name, surname
 	and age to avoid segmentation faults.
 	*/
-	staffmember(std::string namestr, std::string surnamestr, int age); //DONE
+	staffmember(std::string_view namestr, std::string_view surnamestr, int age); //DONE
+	/*
+	Creates a copy carrying the data of the original, but
+	none of its links, and with a handle of its own.
+	*/
+	staffmember(const staffmember& ref);
+	staffmember& operator=(const staffmember&) = delete;
+	/*
+	Returns the generational handle of this staffmember.
+	It stays unique for the lifetime of the object.
+	*/
+	entityhandle getHandle() const;
+	/*
+	Resolves a handle in O(1). If the handle is null or
+	its staffmember was destroyed, returns a reference to a
+	static empty object.
+	*/
+	static staffmember& fromHandle(entityhandle handle);
 	/*
 	Sets name and surname for staffmember.
 	Returns false without changes
@@ -111,16 +173,19 @@ public:
 	- staffmember has any linkage to any other object 
 	  (removes possible unique name check bypass)
 	*/
-	bool setName(std::string namestr, std::string surnamestr); //DONE
+	template <class Policy = defaultvalidation>
+	bool setName(std::string_view namestr, std::string_view surnamestr); //DONE
 	/*
 	Sets staff type. Fails if provided string is empty.
+	Pass an rvalue to move the string in without a copy.
 	*/
+	template <class Policy = defaultvalidation>
 	bool setType(std::string typestr); //DONE
 	/*
-	This method returns a profession string
-	of the staff member.
+	This method returns a reference to the profession
+	string of the staff member.
 	*/
-	std::string getType() const; //DONE
+	const std::string& getType() const; //DONE
 	/*
 	Sets the link to indicate staff as working
 	in a specified hospital. Returns false if:
@@ -128,6 +193,7 @@ public:
 	- staffmember does not have a profession
 	- staffmember already has a hospital assignment
 	*/
+	template <class Policy = defaultvalidation>
 	bool linkToHospital(const hospital& hosp); //DONE
 	/* 
 	This method clears the link of a staffmember
@@ -168,6 +234,8 @@ private:
 	hospital* in_hospital;
 	//a pointer to a room the person is in
 	room* in_room;
+	//handle identifying this object
+	entityhandle self;
 	
 };
 
@@ -175,6 +243,10 @@ private:
 A patient class represents a medical patient
 with a specified illness. Inherits data and
 member methods from class person.
+
+The record is laid out to fit one 64 byte cache
+line: short names inline, age and severity as
+bytes and the condition as a registry ID.
 */
 class patient : public person
 {
@@ -199,7 +271,24 @@ public:
 	Initialises pointers to null, sets name, surname
 	and age to avoid segmentation faults.
 	*/
-	patient(std::string namestr, std::string surnamestr, int age); //DONE
+	patient(std::string_view namestr, std::string_view surnamestr, int age); //DONE
+	/*
+	Creates a copy carrying the data of the original, but
+	none of its links, and with a handle of its own.
+	*/
+	patient(const patient& ref);
+	patient& operator=(const patient&) = delete;
+	/*
+	Returns the generational handle of this patient.
+	It stays unique for the lifetime of the object.
+	*/
+	entityhandle getHandle() const;
+	/*
+	Resolves a handle in O(1). If the handle is null or
+	its patient was destroyed, returns a reference to a
+	static empty object.
+	*/
+	static patient& fromHandle(entityhandle handle);
 	/*
 	Sets name and surname for patient.
 	Returns false without changes
@@ -208,11 +297,30 @@ public:
 	- patient has any linkage to any other object 
 	  (removes possible unique name check bypass)
 	*/
-	bool setName(std::string namestr, std::string surnamestr); //DONE
+	template <class Policy = defaultvalidation>
+	bool setName(std::string_view namestr, std::string_view surnamestr); //DONE
 	/*
 	Sets patient's condition. Fails if provided string is empty.
 	*/
-	bool setCondition(std::string conditionstr); //DONE
+	template <class Policy = defaultvalidation>
+	bool setCondition(std::string_view conditionstr); //DONE
+	/*
+	Sets the age like person::setAge, and lets the hospital
+	of the patient refresh the data derived from it.
+	*/
+	template <class Policy = defaultvalidation>
+	bool setAge(int agecount);
+	/*
+	Sets the triage severity, from 0 (not urgent) to
+	max_severity (see conditions.h). setCondition sets it
+	to the severity of the condition, removeCondition to 0.
+	Fails outside that range.
+	*/
+	bool setSeverity(int level);
+	/*
+	Returns the triage severity of the patient.
+	*/
+	int getSeverity() const;
 	/*
 	Removes patient's condition, setting it to empty
 	string. Patient without condition is condsidered
@@ -221,9 +329,15 @@ public:
 	void removeCondition(); //DONE
 	/*
 	Returns a string indicating an illness of the
-	patient.
+	patient. The reference is valid for good (see
+	conditionName).
 	*/
-	std::string getCondition() const; //DONE
+	const std::string& getCondition() const; //DONE
+	/*
+	Returns the ID of the condition (see conditions.h),
+	0 for a healthy patient.
+	*/
+	uint32_t getConditionId() const;
 	/*
 	Sets the link to indicate patient as treated
 	in a specified hospital. Returns false if:
@@ -266,15 +380,21 @@ public:
 	room& getRoom() const; //DONE
 
 private:
-	//a description of a patient's illness
-	std::string condition;
+	//triage urgency, see setSeverity
+	uint8_t severity;
+	//ID of the patient's illness in the condition registry, 0 if healthy
+	uint32_t condition;
 	//a pointer to a hospital the person is in
 	hospital* in_hospital;
 	//a pointer to a room the person is in
 	room* in_room;
+	//handle identifying this object
+	entityhandle self;
 
 };
 
+static_assert(sizeof(patient) <= 64, "a patient record should fit one cache line");
+
 /*
 A room class represents a treatment room
 where patients are treated, kept under
@@ -295,9 +415,26 @@ friend std::ostream& operator<<(std::ostream& str, const room& rm);
 public:
 	/*
 	Preinitialises pointers to null, and
-	sets the name of the room.
+	sets the name of the room (moved in
+	when passed an rvalue). The patient list
+	takes memory from the given resource.
+	*/
+	room(std::string rmnm, std::pmr::memory_resource* resource = std::pmr::get_default_resource()); //DONE
+	/*
+	Creates an unlinked copy with the same
+	name and resource, and a handle of its own.
+	*/
+	room(const room& ref);
+	room& operator=(const room&) = delete;
+	/*
+	Returns the generational handle of this room.
+	*/
+	entityhandle getHandle() const;
+	/*
+	Resolves a handle in O(1). Returns a reference to a
+	static empty object if the handle is null or stale.
 	*/
-	room(std::string rmnm); //DONE
+	static room& fromHandle(entityhandle handle);
 	/*
 	Removes all linkage of to object to anything
 	else during destruction.
@@ -312,24 +449,46 @@ public:
 	*/
 	bool setName(std::string rmnm); //DONE
 	/*
-	This method returns a copy of the room
-	name.
+	This method returns a reference to the
+	room name.
 	*/
-	std::string getName() const; //DONE
+	const std::string& getName() const; //DONE
 	/*
 	This method attempts to add a patient into
 	the room. Method will return false if:
 	- room does not have a name
 	- patient already appears in the room
+	- the room is full (see setCapacity)
 	- link fails from patient side (see patient::linkToRoom)
 	*/
 	bool addPatient(patient& ptn); //DONE
 	/*
 	Clears a mutual link between a patient and a room.
-	Returns false if no link exists.
+	Returns false if no link exists. The freed bed goes
+	to the next patient waiting for it, if any (see
+	hospital::waitForRoom).
 	*/
 	bool removePatient(patient& ptn); //DONE
 	/*
+	Limits the number of patients in the room, 0 means
+	no limit (the default). A lower limit than the current
+	number of patients only stops new admissions. Raising
+	it admits waiting patients into the new beds.
+	*/
+	void setCapacity(std::size_t beds);
+	/*
+	Returns the limit set with setCapacity.
+	*/
+	std::size_t getCapacity() const;
+	/*
+	Returns the number of patients in the room.
+	*/
+	std::size_t getPatientCount() const;
+	/*
+	Checks if the room has reached its capacity.
+	*/
+	bool isFull() const;
+	/*
 	Prints a list of patients currently in a
 	given room. If a room is empty, an
 	appropriate message is displayed.
@@ -341,7 +500,7 @@ public:
 	is found, the method returns a reference to a static
 	empty object.
 	*/
-	patient& getPatient(std::string nmstr, std::string snstr) const; //DONE
+	patient& getPatient(std::string_view nmstr, std::string_view snstr) const; //DONE
 	/*
 	This method attempts to assign a staff
 	member to caretaker role of the room.
@@ -399,9 +558,31 @@ private:
 	staffmember* assignee;
 	//a pointer to the hospital room is located in
 	hospital* in_hospital;
-	//beginning of the patient list in a given room
-	std::list <patient*> patients;
+	//patients in the room, indexed by name for constant time lookup and removal
+	roompatientregistry patients;
+	//maximum number of patients, 0 if unlimited
+	std::size_t capacity;
+	//handle identifying this object
+	entityhandle self;
+
+};
 
+/*
+Maxima of a hospital with fixed capacity, 0 meaning
+unlimited. Such a hospital takes all the memory of its
+lists, indexes and queues from a fixedarena of its own,
+allocated when it is constructed, so registering,
+discharging, employing and moving people allocates
+nothing once the hospital has been filled up once.
+arenabytes sizes the arena, 0 estimates it from the
+maxima.
+*/
+struct hospitallimits
+{
+	std::size_t rooms = 0;
+	std::size_t staff = 0;
+	std::size_t patients = 0;
+	std::size_t arenabytes = 0;
 };
 
 /*
@@ -413,12 +594,46 @@ class hospital
 
 //displays a hospital name
 friend std::ostream& operator<<(std::ostream& str, const hospital& hosp);
+//patients and rooms report changes of their data
+//through patientChanging/patientChanged and roomChanging/roomChanged,
+//and their link changes through publishEvent
+friend class patient;
+friend class room;
 
 public:
 	/*
-	Sets the name of the hospital.
+	Sets the name of the hospital. Its lists, indexes and
+	queues take memory from the given resource, e.g. a
+	std::pmr::monotonic_buffer_resource for a hospital
+	thrown away as a whole.
+	*/
+	hospital(std::string hsnm, std::pmr::memory_resource* resource = std::pmr::get_default_resource()); //DONE
+	/*
+	Sets the name of a hospital with fixed capacity.
+	Registering, employing or adding beyond the limits
+	fails. Rooms should take memory from a resource of
+	their own (e.g. a fixedarena) for their patient lists
+	not to allocate either. Without any limit it takes
+	memory from the default resource, like a hospital
+	without limits.
 	*/
-	hospital(std::string hsnm); //DONE
+	hospital(std::string hsnm, const hospitallimits& lims);
+	/*
+	Creates a copy with the same name, resource and limits
+	(and an arena of its own if it has any), none of the
+	links, and a handle of its own.
+	*/
+	hospital(const hospital& ref);
+	hospital& operator=(const hospital&) = delete;
+	/*
+	Returns the generational handle of this hospital.
+	*/
+	entityhandle getHandle() const;
+	/*
+	Resolves a handle in O(1). Returns a reference to a
+	static empty object if the handle is null or stale.
+	*/
+	static hospital& fromHandle(entityhandle handle);
 	/*
 	Removes all the linkage of the hospital
 	to any other object, both ways, to avoid
@@ -431,9 +646,9 @@ public:
 	*/
 	bool setName(std::string hsnm); //DONE
 	/*
-	Returns a copy of a hospital name.
+	Returns a reference to the hospital name.
 	*/
-	std::string getName() const; //DONE
+	const std::string& getName() const; //DONE
 	/*
 	This method attempts to register a patient
 	object and add it into patient list.
@@ -461,14 +676,17 @@ public:
 	Method for searching for patient objects and returning their references.
 	Returns constant empty object reference on failure.
 	*/
-	patient& getPatient(std::string nmstr, std::string snstr) const; //DONE
+	patient& getPatient(std::string_view nmstr, std::string_view snstr) const; //DONE
 	/*
 	This method attempts to add a staff memeber.
 	Method fails if:
 	- staffmember refuses the link (see staffmember::linkToHospital)
 	- hospital does not have a name
 	- staffmemeber is already employed in this hospital
+	The link is checked with the given validation policy,
+	trustedinput employs staff without a profession.
 	*/
+	template <class Policy = defaultvalidation>
 	bool employStaff(staffmember& stm); //DONE
 	/*
 	Removes a mutual link to a staff member, returns
@@ -485,7 +703,29 @@ public:
 	Method for searching for staff objects and returning their references.
 	Returns constant empty object reference on failure.
 	*/
-	staffmember& getStaff(std::string namestr, std::string surnamestr) const; //DONE
+	staffmember& getStaff(std::string_view namestr, std::string_view surnamestr) const; //DONE
+	/*
+	Approximate search for people with a typo in their
+	name. The query is a "name surname" string, case does
+	not matter. Returns up to count people whose full name
+	is within maxdistance edits (insertions, deletions or
+	substitutions of a letter) of it, closest first.
+	*/
+	std::vector<patient*> findPatients(std::string_view query, std::size_t count, int maxdistance = 2) const;
+	std::vector<staffmember*> findStaff(std::string_view query, std::size_t count, int maxdistance = 2) const;
+	/*
+	Type-ahead search. Returns up to count people whose
+	surname starts with prefix (case does not matter),
+	in alphabetical order of the surname. Takes time in
+	proportion to the prefix length and count only.
+	*/
+	std::vector<patient*> completePatients(std::string_view prefix, std::size_t count) const;
+	std::vector<staffmember*> completeStaff(std::string_view prefix, std::size_t count) const;
+	/*
+	Returns the heap memory held by the surname tries
+	behind completePatients and completeStaff, in bytes.
+	*/
+	std::size_t surnameIndexMemory() const;
 	/*
 	This method attempts to incorporate a room
 	into the hospital. Returns false if:
@@ -509,7 +749,14 @@ public:
 	Searches for room objects and returns their references.
 	Returns constant empty object reference on failure.
 	*/
-	room& getRoom(std::string nmstr) const;
+	room& getRoom(std::string_view nmstr) const;
+	/*
+	Return the patients, staff and rooms of the hospital
+	in the order they were added, e.g. to copy its state.
+	*/
+	const patientregistry& getPatientList() const;
+	const staffregistry& getStaffList() const;
+	const roomregistry& getRoomList() const;
 	/*
 	Displays the count of staff members,
 	registered patients and amount of rooms in the hospital.
@@ -521,17 +768,189 @@ public:
 	for linkage operations.
 	*/
 	bool isValid() const; //DONE
+	/*
+	Attaches a columnar mirror of the registered patients
+	(see patientcolumns). Rows for the current patients are
+	added at once and kept up to date from then on. The same
+	store may be attached to several hospitals. Returns false
+	if another store is attached already.
+	*/
+	bool attachColumns(patientcolumns& cols);
+	/*
+	Removes the rows of this hospital's patients from the
+	attached store and stops maintaining it. Returns false
+	if no store is attached.
+	*/
+	bool detachColumns();
+	/*
+	Attaches a change feed (see eventfeed). From then on
+	every registration, discharge, employment, dismissal,
+	room change and room link of this hospital publishes
+	an event into it. The feed must outlive the hospital
+	or be detached first. Returns false if another feed
+	is attached already.
+	*/
+	bool attachFeed(eventfeed& fd);
+	/*
+	Stops publishing events. Returns false if no feed
+	is attached.
+	*/
+	bool detachFeed();
+	/*
+	Returns the running aggregates of this hospital
+	(patients per condition, room and age band, healthy
+	and ill patients, staffed and unstaffed rooms).
+	Every read of the returned object is O(1).
+	*/
+	const census& getCensus() const;
+	/*
+	Returns the counts of the memory taken by the lists,
+	indexes and queues of this hospital (not by the rooms,
+	staff and patients themselves, which belong to the
+	caller).
+	*/
+	const countingresource& getMemory() const;
+	/*
+	Returns the limits given on construction, all 0 if none.
+	*/
+	const hospitallimits& getLimits() const;
+	/*
+	Makes room in the patient index for count patients,
+	so registering a known number of them rehashes at
+	most once.
+	*/
+	void reservePatients(std::size_t count);
+	/*
+	Puts a registered patient in the triage queue, stamped
+	with its arrival. Returns false if the patient is not
+	registered here or already waiting. The queue follows
+	later severity changes, discharged patients leave it.
+	*/
+	bool admitToTriage(patient& ptn);
+	/*
+	Takes the most urgent waiting patient (highest severity,
+	then earliest arrival) off the triage queue. Returns an
+	empty object reference if nobody is waiting.
+	*/
+	patient& nextPatient();
+	/*
+	Returns the patient nextPatient() would take, without
+	taking it.
+	*/
+	patient& peekNextPatient() const;
+	/*
+	Removes a patient from the triage queue, returns false
+	if it was not waiting.
+	*/
+	bool leaveTriage(patient& ptn);
+	/*
+	Returns the number of patients waiting in triage.
+	*/
+	std::size_t waitingCount() const;
+	/*
+	Puts a registered patient without a room on the
+	waitlist of a room of this hospital. If the room has
+	a free bed the patient is admitted at once instead.
+	Waiting patients are admitted first come first served
+	whenever a bed of the room frees up, publishing a
+	single event_patient_admitted. Returns false if:
+	- the patient or the room is not in this hospital
+	- the patient already has a room or is waiting
+	*/
+	bool waitForRoom(patient& ptn, room& rm);
+	/*
+	Puts a registered patient without a room on the
+	waitlist of its condition. The patient takes the bed
+	of the next patient with the same condition who leaves
+	a room (after that room's own waitlist is served). If
+	its condition changes it moves to the back of the new
+	condition's waitlist, or leaves it on getting well.
+	Returns false if the patient is healthy, or for the
+	reasons listed in waitForRoom.
+	*/
+	bool waitForBed(patient& ptn);
+	/*
+	Takes a patient off the waitlist it is on, returns
+	false if it is not waiting. Discharged patients and
+	patients put in a room leave their waitlist on their own.
+	*/
+	bool leaveWaitlist(patient& ptn);
+	/*
+	Return the number of patients waiting for a room,
+	or for a bed freed by a condition.
+	*/
+	std::size_t waitlistLength(const room& rm) const;
+	std::size_t waitlistLength(std::string_view conditionstr) const;
 	
 
 private:
+	//memory of a hospital with fixed capacity, or nullptr
+	std::unique_ptr<fixedarena> arena;
+	hospitallimits limits;
+	//counts what the containers below take from the resource,
+	//so it is constructed first and destroyed last
+	countingresource memory;
 	//string descirbing hospital name
 	std::string name;
-	//list of pointers to staff members
-	std::list <staffmember*> stafflist;
-	//list of pointers to rooms in the hospital
-	std::list <room*> roomlist;
-	//list of pointers to registered patients
-	std::list <patient*> patients;
+	//handle identifying this object
+	entityhandle self;
+	//optional columnar mirror of the patients, or nullptr
+	patientcolumns* columns;
+	//running aggregates of patients and rooms
+	census counts;
+	//optional change feed, or nullptr
+	eventfeed* feed;
+	//patients waiting for treatment, and the next arrival stamp
+	triagequeue triage;
+	uint64_t arrivals;
+	//trigram indexes over the full names of patients and staff
+	trigramindex patientnames;
+	trigramindex staffnames;
+	//radix tries over the surnames of patients and staff
+	surnametrie patientsurnames;
+	surnametrie staffsurnames;
+	//patients waiting for a bed, by room handle index and by condition ID
+	std::pmr::unordered_map <uint32_t, waitlist> roomwaits;
+	std::pmr::unordered_map <uint32_t, waitlist> conditionwaits;
+	//patient handle index -> the waitlist it is on
+	std::pmr::unordered_map <uint32_t, waitlist*> waitingon;
+	//room taking a patient off its waitlist, or nullptr
+	const room* handingoff;
+	/*
+	Staff members, rooms and registered patients, indexed by
+	name, so lookup, duplicate checks and removal do not scan.
+	*/
+	staffregistry stafflist;
+	roomregistry roomlist;
+	patientregistry patients;
+	/*
+	Called by a registered patient right before and right
+	after its data changes, so derived data can drop the
+	old values and count the new ones.
+	*/
+	void patientChanging(const patient& ptn);
+	void patientChanged(const patient& ptn);
+	//the same for a room of this hospital
+	void roomChanging(const room& rm);
+	/*
+	Called by a room of this hospital when a bed may have
+	freed up. Admits waiting patients into the free beds,
+	first from its own waitlist, then from the waitlist of
+	the condition of the patient who left (if any). A room
+	without a limit takes one patient for the one who left.
+	*/
+	void roomFreed(room& rm, const patient* left);
+	/*
+	Called by a registered patient whose condition changed.
+	A patient on the waitlist of the old condition joins the
+	back of the new one's, or leaves it on getting well.
+	*/
+	void conditionChanged(patient& ptn, uint32_t previous);
+	//publishes a mutation to the attached feed, if any
+	void publishEvent(eventkind kind, entityhandle subject, entityhandle target);
+	void roomChanged(const room& rm);
+	//takes memory from an arena of its own if any limit is set
+	hospital(std::string hsnm, const hospitallimits& lims, std::pmr::memory_resource* resource);
 
 };
 
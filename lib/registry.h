@@ -0,0 +1,507 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        registry header file
+*/
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "keyfilter.h"
+
+/*
+Mixes the hashes of a name and a surname, so swapped
+pairs hash differently.
+*/
+inline std::size_t nameHash(std::string_view nmstr, std::string_view snstr)
+{
+	std::size_t h = std::hash<std::string_view>()(nmstr);
+	return h ^ (std::hash<std::string_view>()(snstr) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+}
+
+/*
+Spreads the bits of a hash, so weak ones such as
+std::hash of a string fill filters and partitions evenly
+(the 64 bit finaliser of MurmurHash3).
+*/
+inline uint64_t remix(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	return hash ^ (hash >> 33);
+}
+
+/*
+Registry key of a person, its name and surname. The views
+point into the person, whose name cannot change while it
+is registered anywhere. The hash is computed once, on
+first use, so a key passed through a filter and an index
+is hashed only once.
+*/
+struct personkey
+{
+	std::string_view name;
+	std::string_view surname;
+	mutable std::size_t hashed = 0;
+	mutable bool known = false;
+
+	template <class T>
+	static personkey of(const T& item) { return {item.getName(), item.getSurname()}; }
+	std::size_t hash() const
+	{
+		if(!known) hashed = nameHash(name, surname), known = true;
+		return hashed;
+	}
+	bool operator==(const personkey& other) const { return name == other.name && surname == other.surname; }
+	auto operator<=>(const personkey& other) const
+	{
+		if(auto order = name <=> other.name; order != 0) return order;
+		return surname <=> other.surname;
+	}
+};
+
+/*
+Registry key of a room, its name. Hashed once like
+personkey.
+*/
+struct namekey
+{
+	std::string_view name;
+	mutable std::size_t hashed = 0;
+	mutable bool known = false;
+
+	template <class T>
+	static namekey of(const T& item) { return {item.getName()}; }
+	std::size_t hash() const
+	{
+		if(!known) hashed = nameHash(name, ""), known = true;
+		return hashed;
+	}
+	bool operator==(const namekey& other) const { return name == other.name; }
+	auto operator<=>(const namekey& other) const { return name <=> other.name; }
+};
+
+namespace registrydetail
+{
+
+//grows a hash index for count entries, at least twofold so
+//reserving a little more each time stays cheap
+template <class Index>
+void growIndex(Index& index, std::size_t count)
+{
+	if(count <= index.bucket_count() * index.max_load_factor()) return;
+	index.reserve(std::max(count, 2 * index.size()));
+}
+
+}
+
+/*
+Storage policies of a registry. Each one provides
+
+	template <class T, class Key> class storage
+
+holding pointers to the registered objects, with:
+
+	storage(std::pmr::memory_resource* resource)
+	iterator begin() const, end() const	(yielding T*)
+	std::size_t size() const
+	T* find(const Key& key) const		(nullptr if none)
+	void insert(T& item, const Key& key)	(the key is new)
+	bool erase(const T& item)		(false if not there)
+	void reserve(std::size_t count)
+
+A list with a hash index: insertion order, every
+operation O(1). What the hospital and rooms use.
+*/
+struct listpolicy
+{
+	template <class T, class Key>
+	class storage
+	{
+
+	public:
+		using iterator = typename std::pmr::list<T*>::const_iterator;
+
+		storage(std::pmr::memory_resource* resource) : items(resource), index(resource) {}
+		iterator begin() const { return items.begin(); }
+		iterator end() const { return items.end(); }
+		std::size_t size() const { return items.size(); }
+		T* find(const Key& key) const
+		{
+			//empty list optimisation
+			if(items.empty()) return nullptr;
+			//only entries with a matching hash have to be compared
+			auto range = index.equal_range(key.hash());
+			for(auto entry = range.first; entry != range.second; entry++)
+				if(Key::of(**(entry -> second)) == key) return *(entry -> second);
+			return nullptr;
+		}
+		void insert(T& item, const Key& key)
+		{
+			items.push_back(&item);
+			index.emplace(key.hash(), std::prev(items.end()));
+		}
+		bool erase(const T& item)
+		{
+			auto range = index.equal_range(Key::of(item).hash());
+			for(auto entry = range.first; entry != range.second; entry++)
+			{
+				if(*(entry -> second) != &item) continue;
+				items.erase(entry -> second);
+				index.erase(entry);
+				return true;
+			}
+			return false;
+		}
+		void reserve(std::size_t count) { registrydetail::growIndex(index, count); }
+
+	private:
+		std::pmr::list<T*> items;
+		//key hash -> list position
+		std::pmr::unordered_multimap<std::size_t, iterator> index;
+
+	};
+};
+
+/*
+A vector with a hash index. Iterates faster and takes a
+node less per object than the list, but erasing moves the
+last object into the gap, so the order is not kept.
+*/
+struct vectorpolicy
+{
+	template <class T, class Key>
+	class storage
+	{
+
+	public:
+		using iterator = typename std::pmr::vector<T*>::const_iterator;
+
+		storage(std::pmr::memory_resource* resource) : items(resource), index(resource) {}
+		iterator begin() const { return items.begin(); }
+		iterator end() const { return items.end(); }
+		std::size_t size() const { return items.size(); }
+		T* find(const Key& key) const
+		{
+			if(items.empty()) return nullptr;
+			auto range = index.equal_range(key.hash());
+			for(auto entry = range.first; entry != range.second; entry++)
+				if(Key::of(*items[entry -> second]) == key) return items[entry -> second];
+			return nullptr;
+		}
+		void insert(T& item, const Key& key)
+		{
+			index.emplace(key.hash(), items.size());
+			items.push_back(&item);
+		}
+		bool erase(const T& item)
+		{
+			auto entry = locate(&item);
+			if(entry == index.end()) return false;
+			std::size_t pos = entry -> second;
+			index.erase(entry);
+			//move the last object into the gap
+			T* last = items.back();
+			items.pop_back();
+			if(pos == items.size()) return true;
+			items[pos] = last;
+			locate(last) -> second = pos;
+			return true;
+		}
+		void reserve(std::size_t count)
+		{
+			items.reserve(count);
+			registrydetail::growIndex(index, count);
+		}
+
+	private:
+		std::pmr::vector<T*> items;
+		//key hash -> vector position
+		std::pmr::unordered_multimap<std::size_t, std::size_t> index;
+
+		typename std::pmr::unordered_multimap<std::size_t, std::size_t>::iterator locate(const T* item)
+		{
+			auto range = index.equal_range(Key::of(*item).hash());
+			for(auto entry = range.first; entry != range.second; entry++)
+				if(items[entry -> second] == item) return entry;
+			return index.end();
+		}
+
+	};
+};
+
+/*
+A search tree ordered by the key, so iteration is sorted
+(by name, then surname). Every operation is O(log n).
+*/
+struct orderedpolicy
+{
+	template <class T, class Key>
+	class storage
+	{
+
+		using tree = std::pmr::map<Key, T*>;
+
+	public:
+		//walks the tree yielding the objects instead of the entries
+		class iterator
+		{
+
+		public:
+			iterator(typename tree::const_iterator pos) : at(pos) {}
+			T* operator*() const { return at -> second; }
+			iterator& operator++() { ++at; return *this; }
+			bool operator==(const iterator& other) const { return at == other.at; }
+
+		private:
+			typename tree::const_iterator at;
+
+		};
+
+		storage(std::pmr::memory_resource* resource) : items(resource) {}
+		iterator begin() const { return iterator(items.begin()); }
+		iterator end() const { return iterator(items.end()); }
+		std::size_t size() const { return items.size(); }
+		T* find(const Key& key) const
+		{
+			auto found = items.find(key);
+			return found == items.end() ? nullptr : found -> second;
+		}
+		void insert(T& item, const Key& key) { items.emplace(key, &item); }
+		bool erase(const T& item)
+		{
+			auto found = items.find(Key::of(item));
+			if(found == items.end() || found -> second != &item) return false;
+			items.erase(found);
+			return true;
+		}
+		void reserve(std::size_t) {}
+
+	private:
+		tree items;
+
+	};
+};
+
+/*
+Splits the objects by key hash over Shards storages of
+another policy. Each shard rehashes on its own, so growing
+a large registry stalls an operation for a fraction of the
+time. Iterates shard by shard.
+*/
+template <class Inner = listpolicy, std::size_t Shards = 16>
+struct shardedpolicy
+{
+	template <class T, class Key>
+	class storage
+	{
+
+		using shard = typename Inner::template storage<T, Key>;
+
+	public:
+		//walks the shards in order, skipping the empty ones
+		class iterator
+		{
+
+		public:
+			iterator(const storage* owner, std::size_t shardno) : of(owner), which(shardno)
+			{
+				if(which < Shards) at = of -> shards[which].begin();
+				settle();
+			}
+			T* operator*() const { return *at; }
+			iterator& operator++()
+			{
+				++at;
+				settle();
+				return *this;
+			}
+			bool operator==(const iterator& other) const
+			{
+				return which == other.which && (which == Shards || at == other.at);
+			}
+
+		private:
+			const storage* of;
+			std::size_t which;
+			typename shard::iterator at;
+
+			void settle()
+			{
+				while(which < Shards && at == of -> shards[which].end())
+					if(++which < Shards) at = of -> shards[which].begin();
+			}
+
+		};
+
+		storage(std::pmr::memory_resource* resource) : shards(resource)
+		{
+			shards.reserve(Shards);
+			for(std::size_t i = 0; i < Shards; i++) shards.emplace_back(resource);
+		}
+		iterator begin() const { return iterator(this, 0); }
+		iterator end() const { return iterator(this, Shards); }
+		std::size_t size() const
+		{
+			std::size_t total = 0;
+			for(const shard& s : shards) total += s.size();
+			return total;
+		}
+		T* find(const Key& key) const { return shards[shardOf(key)].find(key); }
+		void insert(T& item, const Key& key) { shards[shardOf(key)].insert(item, key); }
+		bool erase(const T& item) { return shards[shardOf(Key::of(item))].erase(item); }
+		void reserve(std::size_t count)
+		{
+			for(shard& s : shards) s.reserve(count / Shards + 1);
+		}
+
+	private:
+		std::pmr::vector<shard> shards;
+
+		//high bits, the shards hash the low ones into buckets again
+		static std::size_t shardOf(const Key& key)
+		{
+			return ((key.hash() * 0x9e3779b97f4a7c15ull) >> 32) % Shards;
+		}
+
+	};
+};
+
+/*
+Puts a counting Bloom filter (see keyfilter) in front of
+the storage of another policy, so a lookup of a key that
+is not there, the usual case before an insertion, mostly
+skips the index. PerMillion is the target false positive
+rate, 1% by default. The filter is rebuilt twice as big
+whenever it fills up.
+*/
+template <class Inner = listpolicy, unsigned PerMillion = 10000>
+struct filteredpolicy
+{
+	template <class T, class Key>
+	class storage
+	{
+
+		using inner = typename Inner::template storage<T, Key>;
+
+	public:
+		using iterator = typename inner::iterator;
+
+		storage(std::pmr::memory_resource* resource) : items(resource), filter(initial_keys, PerMillion / 1e6, resource) {}
+		iterator begin() const { return items.begin(); }
+		iterator end() const { return items.end(); }
+		std::size_t size() const { return items.size(); }
+		T* find(const Key& key) const
+		{
+			if(!filter.mayContain(key.hash())) return nullptr;
+			return items.find(key);
+		}
+		void insert(T& item, const Key& key)
+		{
+			items.insert(item, key);
+			if(filter.size() < filter.capacity()) filter.add(key.hash());
+			else rebuild(2 * items.size());
+		}
+		bool erase(const T& item)
+		{
+			if(!items.erase(item)) return false;
+			filter.remove(Key::of(item).hash());
+			return true;
+		}
+		void reserve(std::size_t count)
+		{
+			items.reserve(count);
+			if(count > filter.capacity()) rebuild(count);
+		}
+
+	private:
+		static constexpr std::size_t initial_keys = 64;
+		inner items;
+		keyfilter filter;
+
+		void rebuild(std::size_t count)
+		{
+			filter.reset(count);
+			for(T* item : items) filter.add(Key::of(*item).hash());
+		}
+
+	};
+};
+
+/*
+Objects of type T registered under unique keys of type
+Key (see personkey), stored as Policy chooses (see
+listpolicy). The registry keeps pointers, the objects
+belong to the caller.
+*/
+template <class T, class Key, class Policy = listpolicy>
+class registry
+{
+
+public:
+	using storage = typename Policy::template storage<T, Key>;
+	using iterator = typename storage::iterator;
+
+	registry(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : memory(resource), store(resource) {}
+	/*
+	Returns the resource the registry takes memory from.
+	*/
+	std::pmr::memory_resource* resource() const { return memory; }
+	/*
+	Return the number of objects, and whether there are none.
+	*/
+	std::size_t size() const { return store.size(); }
+	bool empty() const { return store.size() == 0; }
+	/*
+	Iterate over the objects, yielding T*.
+	*/
+	iterator begin() const { return store.begin(); }
+	iterator end() const { return store.end(); }
+	/*
+	Returns the object registered under a key, nullptr if none.
+	*/
+	T* find(const Key& key) const { return store.find(key); }
+	bool contains(const Key& key) const { return store.find(key) != nullptr; }
+	/*
+	Adds an object under its key. Returns false if the
+	key is taken already.
+	*/
+	bool insert(T& item)
+	{
+		Key key = Key::of(item);
+		if(store.find(key) != nullptr) return false;
+		store.insert(item, key);
+		return true;
+	}
+	/*
+	Removes an object, returns false if this very object
+	is not registered.
+	*/
+	bool erase(const T& item) { return store.erase(item); }
+	/*
+	Makes room for count objects, so adding that many
+	does not rehash.
+	*/
+	void reserve(std::size_t count) { store.reserve(count); }
+
+private:
+	std::pmr::memory_resource* memory;
+	storage store;
+
+};
+
+#endif
@@ -0,0 +1,380 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        server source file
+*/
+
+#include "server.h"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef debug_msg
+#define debug(method, message) std::cerr << #method << ": " << #message << "!\n"
+#else
+#define debug(method, message)
+#endif
+
+namespace
+{
+
+//a request line longer than this closes the connection
+const std::size_t max_line = 4096;
+
+struct connection
+{
+	std::string input;
+	std::string output;
+	bool closing = false;
+	bool writing = false;
+};
+
+std::string handleText(entityhandle handle)
+{
+	return std::to_string(handle.index) + "." + std::to_string(handle.generation);
+}
+
+//returns false if epoll refused the descriptor
+bool watch(int epoll, int fd, bool writing, int op)
+{
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	if(writing) ev.events |= EPOLLOUT;
+	ev.data.fd = fd;
+	return epoll_ctl(epoll, op, fd, &ev) == 0;
+}
+
+}
+
+admissionserver::admissionserver(hospital& hs)
+{
+	hosp = &hs;
+	running = false;
+	requests = 0;
+	records = 0;
+	readonly = false;
+	journal = nullptr;
+	follow = nullptr;
+}
+
+admissionserver::~admissionserver()
+{
+	//discharge the patients of this server before the hospital goes
+	for(auto& entry : owned) hosp -> dischargePatient(*entry.second);
+}
+
+std::string admissionserver::execute(const std::string& line)
+{
+	requests++;
+	std::string cmd = line.substr(0, line.find(' '));
+	bool mutation = cmd == "REG" || cmd == "DIS" || cmd == "MOV";
+	if(mutation && readonly) return "ERR read-only replica";
+	std::string answer = apply(line);
+	//only mutations that took effect are journaled
+	if(mutation && journal != nullptr && answer.compare(0, 2, "OK") == 0) journal -> append(line);
+	return answer;
+}
+
+void admissionserver::attachJournal(journalwriter& jw)
+{
+	journal = &jw;
+}
+
+void admissionserver::setReadOnly(bool ro)
+{
+	readonly = ro;
+}
+
+bool admissionserver::replay(const std::string& line)
+{
+	records++;
+	std::istringstream in(line);
+	std::string cmd, nm, sn, rest;
+	in >> cmd;
+	if(cmd == "HOSP")
+	{
+		if(!readLast(in, rest)) return false;
+		return hosp -> setName(rest);
+	}
+	if(cmd == "ROOM")
+	{
+		if(!readLast(in, rest)) return false;
+		std::unique_ptr<room> rm(new room(rest));
+		if(!hosp -> addRoom(*rm)) return false;
+		ownedrooms.push_back(std::move(rm));
+		return true;
+	}
+	if(cmd == "STAFF")
+	{
+		int age;
+		if(!readField(in, nm) || !readField(in, sn) || !(in >> age) || !readLast(in, rest)) return false;
+		std::unique_ptr<staffmember> stm(new staffmember(nm, sn, age));
+		stm -> setType(rest);
+		if(!hosp -> employStaff(*stm)) return false;
+		ownedstaff.push_back(std::move(stm));
+		return true;
+	}
+	if(cmd == "ASSIGN")
+	{
+		if(!readField(in, nm) || !readField(in, sn) || !readLast(in, rest)) return false;
+		return hosp -> getRoom(rest).linkStaff(hosp -> getStaff(nm, sn));
+	}
+	return apply(line).compare(0, 2, "OK") == 0;
+}
+
+void admissionserver::followJournal(journalreader& jr)
+{
+	follow = &jr;
+}
+
+uint64_t admissionserver::replayed() const
+{
+	return records;
+}
+
+std::string admissionserver::apply(const std::string& line)
+{
+	std::istringstream in(line);
+	std::string cmd, nm, sn;
+	in >> cmd;
+	if(cmd == "STAT")
+	{
+		const census& cns = hosp -> getCensus();
+		return "OK patients " + std::to_string(cns.patients()) +
+			" ill " + std::to_string(cns.ill()) +
+			" unroomed " + std::to_string(cns.withoutRoom()) +
+			" rooms " + std::to_string(cns.rooms()) +
+			" staffed " + std::to_string(cns.staffedRooms());
+	}
+	if(cmd != "REG" && cmd != "DIS" && cmd != "GET" && cmd != "MOV") return "ERR unknown command";
+	if(!readField(in, nm) || !readField(in, sn)) return "ERR missing name or surname";
+	if(cmd == "REG")
+	{
+		int age;
+		std::string condition;
+		if(!(in >> age)) return "ERR missing age";
+		readField(in, condition);
+		std::unique_ptr<patient> ptn(new patient(nm, sn, 0));
+		if(!ptn -> setAge(age)) return "ERR invalid age";
+		if(condition != "") ptn -> setCondition(condition);
+		if(!hosp -> registerPatient(*ptn)) return "ERR already registered";
+		entityhandle handle = ptn -> getHandle();
+		owned[handle.pack()] = std::move(ptn);
+		return "OK " + handleText(handle);
+	}
+	patient& ptn = hosp -> getPatient(nm, sn);
+	if(!ptn.isValid()) return "ERR no such patient";
+	if(cmd == "GET")
+	{
+		std::string condition = ptn.getCondition();
+		room& rm = ptn.getRoom();
+		return "OK " + quoteField(nm) + " " + quoteField(sn) + " " + std::to_string(ptn.getAge()) + " " +
+			(condition == "" ? "-" : quoteField(condition)) + " " + (rm.isValid() ? quoteLast(rm.getName()) : "-");
+	}
+	if(cmd == "DIS")
+	{
+		uint64_t packed = ptn.getHandle().pack();
+		hosp -> dischargePatient(ptn);
+		//frees the patient if this server registered it
+		owned.erase(packed);
+		return "OK discharged";
+	}
+	//MOV
+	//room names may contain spaces, so the room takes the rest of the line
+	std::string rmname;
+	bool bare = (in >> std::ws).peek() != '"';
+	if(!readLast(in, rmname)) return "ERR missing room";
+	room& from = ptn.getRoom();
+	if(bare && rmname == "-")
+	{
+		if(from.isValid()) from.removePatient(ptn);
+		return "OK moved";
+	}
+	room& to = hosp -> getRoom(rmname);
+	if(!to.isValid()) return "ERR no such room";
+	//refused before the patient leaves, as the freed bed may go to a waiting patient
+	if(&to == &from) return "ERR already in the room";
+	if(to.isFull()) return "ERR move refused";
+	if(from.isValid()) from.removePatient(ptn);
+	if(!to.addPatient(ptn))
+	{
+		//put the patient back where it was
+		if(from.isValid()) from.addPatient(ptn);
+		return "ERR move refused";
+	}
+	return "OK moved";
+}
+
+bool admissionserver::serve(const std::string& path)
+{
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(addr.sun_path))
+	{
+		debug(admissionserver::serve, socket path is too long);
+		return false;
+	}
+	std::strcpy(addr.sun_path, path.c_str());
+	int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(listener < 0)
+	{
+		debug(admissionserver::serve, could not create a socket);
+		return false;
+	}
+	unlink(path.c_str());
+	if(bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, SOMAXCONN) < 0)
+	{
+		debug(admissionserver::serve, could not listen on the path);
+		close(listener);
+		return false;
+	}
+	int epoll = epoll_create1(EPOLL_CLOEXEC);
+	if(epoll < 0 || !watch(epoll, listener, false, EPOLL_CTL_ADD))
+	{
+		debug(admissionserver::serve, could not poll the socket);
+		if(epoll >= 0) close(epoll);
+		close(listener);
+		unlink(path.c_str());
+		return false;
+	}
+	std::unordered_map<int, connection> clients;
+	std::vector<int> ready;
+	epoll_event events[64];
+	char buffer[1 << 16];
+	running = true;
+	while(running)
+	{
+		//catch up with the primary before answering anything
+		if(follow != nullptr) follow -> poll([this](const std::string& record) { replay(record); });
+		//short timeout, so stop() and new journal records are noticed without traffic
+		int count = epoll_wait(epoll, events, 64, follow != nullptr ? 10 : 100);
+		if(count < 0)
+		{
+			if(errno == EINTR) continue;
+			break;
+		}
+		ready.clear();
+		//gather input of every ready connection
+		for(int i = 0; i < count; i++)
+		{
+			int fd = events[i].data.fd;
+			if(fd == listener)
+			{
+				int client;
+				while((client = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+				{
+					//a connection that cannot be polled would never be answered
+					if(!watch(epoll, client, false, EPOLL_CTL_ADD))
+					{
+						close(client);
+						continue;
+					}
+					clients[client];
+				}
+				continue;
+			}
+			connection& conn = clients[fd];
+			if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			{
+				while(true)
+				{
+					ssize_t got = read(fd, buffer, sizeof(buffer));
+					if(got > 0)
+					{
+						conn.input.append(buffer, got);
+						continue;
+					}
+					if(got < 0 && errno == EINTR) continue;
+					//end of stream or a broken connection
+					if(got == 0 || errno != EAGAIN) conn.closing = true;
+					break;
+				}
+			}
+			ready.push_back(fd);
+		}
+		//apply all complete requests as one batch
+		for(int fd : ready)
+		{
+			connection& conn = clients[fd];
+			std::size_t start = 0, end;
+			while((end = conn.input.find('\n', start)) != std::string::npos)
+			{
+				std::string line = conn.input.substr(start, end - start);
+				start = end + 1;
+				if(!line.empty() && line.back() == '\r') line.pop_back();
+				if(line == "QUIT")
+				{
+					conn.closing = true;
+					break;
+				}
+				conn.output += execute(line);
+				conn.output += '\n';
+			}
+			conn.input.erase(0, start);
+			if(conn.input.size() > max_line) conn.closing = true;
+		}
+		//the whole batch reaches the journal with one write, before it is answered
+		if(journal != nullptr) journal -> flush();
+		//answer each connection with a single write
+		for(int fd : ready)
+		{
+			connection& conn = clients[fd];
+			while(!conn.output.empty())
+			{
+				ssize_t sent = send(fd, conn.output.data(), conn.output.size(), MSG_NOSIGNAL);
+				if(sent > 0)
+				{
+					conn.output.erase(0, sent);
+					continue;
+				}
+				if(sent < 0 && errno == EINTR) continue;
+				//the peer is gone, drop what it will never read
+				if(errno != EAGAIN)
+				{
+					conn.closing = true;
+					conn.output.clear();
+				}
+				break;
+			}
+			if(conn.closing && conn.output.empty())
+			{
+				close(fd);
+				clients.erase(fd);
+				continue;
+			}
+			//wait for room in the socket buffer only while answers are pending
+			bool pending = !conn.output.empty();
+			if(pending != conn.writing)
+			{
+				conn.writing = pending;
+				if(!watch(epoll, fd, pending, EPOLL_CTL_MOD))
+				{
+					close(fd);
+					clients.erase(fd);
+				}
+			}
+		}
+	}
+	for(auto& entry : clients) close(entry.first);
+	close(epoll);
+	close(listener);
+	unlink(path.c_str());
+	return true;
+}
+
+void admissionserver::stop()
+{
+	running = false;
+}
+
+uint64_t admissionserver::served() const
+{
+	return requests;
+}
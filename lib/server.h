@@ -0,0 +1,129 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        server header file
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "objects.h"
+#include "journal.h"
+
+/*
+Serves a hospital to front-desk clients over a Unix
+domain socket. The protocol is line based, one request
+per line, answered by one line in the same order:
+
+	REG <name> <surname> <age> [condition]
+	DIS <name> <surname>
+	GET <name> <surname>
+	MOV <name> <surname> <room>    (rest of the line, '-' leaves any room)
+	STAT
+	QUIT                           (closes the connection)
+
+Names and conditions with spaces are written in double
+quotes (see quoteField), e.g. REG Ann "Smith-Jones 2" 40.
+
+Answers start with "OK" followed by the result, or with
+"ERR" followed by the reason.
+
+Clients may pipeline: send many requests without waiting
+for answers. The server runs a single epoll loop; in one
+wake-up it reads every ready connection, applies all
+complete requests as one batch and then writes each
+connection's answers with a single write.
+
+A primary server may write every applied mutation to a
+journal (see journalwriter). A read-only replica follows
+that journal and replays it into its own hospital, so
+reporting queries (GET, STAT) never touch the primary.
+*/
+class admissionserver
+{
+
+public:
+	/*
+	Serves the given hospital, which must outlive the
+	server. Patients registered through REG are owned
+	by the server and freed on discharge or destruction.
+	*/
+	admissionserver(hospital& hosp);
+	~admissionserver();
+	admissionserver(const admissionserver&) = delete;
+	admissionserver& operator=(const admissionserver&) = delete;
+	/*
+	Applies one request line (without the newline) and
+	returns its answer line.
+	*/
+	std::string execute(const std::string& line);
+	/*
+	Appends every mutation applied from now on (REG, DIS
+	and MOV answered with OK) to a journal, which must
+	outlive the server. Write a snapshot into it first
+	if the hospital is not empty.
+	*/
+	void attachJournal(journalwriter& jw);
+	/*
+	In read-only mode REG, DIS and MOV are refused.
+	*/
+	void setReadOnly(bool ro);
+	/*
+	Applies one journal record, including the snapshot
+	records. Rooms and staff created by it are owned by
+	the server. Returns false if the record was refused.
+	*/
+	bool replay(const std::string& line);
+	/*
+	Makes serve() replay new records of a journal as they
+	appear, polling it at least every 10 ms, which bounds
+	the lag behind the primary. The reader must outlive
+	the server.
+	*/
+	void followJournal(journalreader& jr);
+	/*
+	Returns the number of journal records replayed.
+	*/
+	uint64_t replayed() const;
+	/*
+	Listens on a socket path (replacing a stale socket
+	file) and serves until stop() is called. Returns
+	false if the socket could not be set up.
+	*/
+	bool serve(const std::string& path);
+	/*
+	Makes serve() return after the current batch.
+	Safe to call from a signal handler.
+	*/
+	void stop();
+	/*
+	Returns the number of requests answered so far.
+	*/
+	uint64_t served() const;
+
+private:
+	hospital* hosp;
+	std::atomic<bool> running;
+	uint64_t requests;
+	uint64_t records;
+	bool readonly;
+	journalwriter* journal;
+	journalreader* follow;
+	//rooms and staff created by replay, destroyed after the patients
+	std::vector<std::unique_ptr<room>> ownedrooms;
+	std::vector<std::unique_ptr<staffmember>> ownedstaff;
+	//patients registered through REG, by packed handle
+	std::unordered_map<uint64_t, std::unique_ptr<patient>> owned;
+
+	//applies a protocol request, whatever the mode
+	std::string apply(const std::string& line);
+
+};
+
+#endif
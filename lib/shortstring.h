@@ -0,0 +1,129 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+      short string header file
+*/
+
+#ifndef SHORTSTRING_H
+#define SHORTSTRING_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/*
+A 16 byte string for names. Up to 15 characters are
+stored inside the object, which covers nearly every
+name, and only longer ones are copied to the heap.
+std::string takes 32 bytes for the same 15 characters.
+
+The last byte tells the two apart: inline strings keep
+15 - length there (so a full inline string ends with a
+zero terminator), heap strings keep heap_tag, with the
+pointer and the length at the front.
+*/
+class shortstring
+{
+
+public:
+	static constexpr std::size_t inline_capacity = 15;
+
+	shortstring() noexcept { setInline("", 0); }
+	shortstring(std::string_view str) { assign(str); }
+	shortstring(const char* str) { assign(str); }
+	shortstring(const std::string& str) { assign(str); }
+	shortstring(const shortstring& ref) { assign(ref.view()); }
+	shortstring(shortstring&& ref) noexcept
+	{
+		std::memcpy(bytes, ref.bytes, sizeof(bytes));
+		ref.setInline("", 0);
+	}
+	shortstring& operator=(const shortstring& ref)
+	{
+		if(this != &ref) *this = ref.view();
+		return *this;
+	}
+	shortstring& operator=(shortstring&& ref) noexcept
+	{
+		if(this == &ref) return *this;
+		release();
+		std::memcpy(bytes, ref.bytes, sizeof(bytes));
+		ref.setInline("", 0);
+		return *this;
+	}
+	shortstring& operator=(std::string_view str)
+	{
+		//copied first, the source may live in our own heap block
+		return *this = shortstring(str);
+	}
+	shortstring& operator=(const std::string& str) { return *this = std::string_view(str); }
+	shortstring& operator=(const char* str) { return *this = std::string_view(str); }
+	~shortstring() { release(); }
+
+	/*
+	Return the characters, always zero terminated.
+	*/
+	std::string_view view() const noexcept { return {data(), size()}; }
+	operator std::string_view() const noexcept { return view(); }
+	operator std::string() const { return std::string(view()); }
+	const char* data() const noexcept { return isHeap() ? heapText() : bytes; }
+	std::size_t size() const noexcept
+	{
+		if(!isHeap()) return inline_capacity - (unsigned char)bytes[inline_capacity];
+		uint32_t length;
+		std::memcpy(&length, bytes + sizeof(char*), sizeof(length));
+		return length;
+	}
+	bool empty() const noexcept { return size() == 0; }
+	/*
+	Checks if the characters are kept on the heap.
+	*/
+	bool isHeap() const noexcept { return (unsigned char)bytes[inline_capacity] == heap_tag; }
+
+	bool operator==(const shortstring& ref) const noexcept { return view() == ref.view(); }
+	bool operator==(std::string_view str) const noexcept { return view() == str; }
+	bool operator==(const char* str) const noexcept { return view() == str; }
+	bool operator==(const std::string& str) const noexcept { return view() == str; }
+
+private:
+	static constexpr unsigned char heap_tag = 0xFF;
+	char bytes[16];
+
+	void setInline(const char* text, std::size_t length) noexcept
+	{
+		std::memcpy(bytes, text, length);
+		std::memset(bytes + length, 0, inline_capacity - length);
+		bytes[inline_capacity] = char(inline_capacity - length);
+	}
+	void assign(std::string_view str)
+	{
+		if(str.size() <= inline_capacity) return setInline(str.data(), str.size());
+		char* text = new char[str.size() + 1];
+		std::memcpy(text, str.data(), str.size());
+		text[str.size()] = '\0';
+		uint32_t length = str.size();
+		std::memcpy(bytes, &text, sizeof(text));
+		std::memcpy(bytes + sizeof(text), &length, sizeof(length));
+		bytes[inline_capacity] = char(heap_tag);
+	}
+	const char* heapText() const noexcept
+	{
+		const char* text;
+		std::memcpy(&text, bytes, sizeof(text));
+		return text;
+	}
+	void release() noexcept
+	{
+		if(isHeap()) delete[] heapText();
+	}
+
+};
+
+inline std::ostream& operator<<(std::ostream& str, const shortstring& sstr)
+{
+	return str << sstr.view();
+}
+
+#endif
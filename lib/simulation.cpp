@@ -0,0 +1,281 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       simulation source file
+*/
+
+#include "simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <thread>
+
+namespace
+{
+
+constexpr uint32_t no_position = UINT32_MAX;
+
+//earliest entry on top of the heap, ties in order of scheduling
+template <class Entry>
+bool laterThan(const Entry& a, const Entry& b)
+{
+	if(a.time != b.time) return a.time > b.time;
+	return a.order > b.order;
+}
+
+}
+
+double distribution::sample(populationrandom& rng) const
+{
+	switch(kind)
+	{
+		case fixed: return std::max(mean, 0.0);
+		//1 - unit() is in (0;1], so the logarithm is finite
+		case exponential: return -mean * std::log(1.0 - rng.unit());
+		case lognormal:
+		{
+			if(mean <= 0) return 0;
+			double sigma2 = std::log(1.0 + (spread * spread) / (mean * mean));
+			double mu = std::log(mean) - sigma2 / 2;
+			//Box-Muller transform of two uniforms into a standard normal
+			double normal = std::sqrt(-2.0 * std::log(1.0 - rng.unit())) * std::cos(2.0 * std::numbers::pi * rng.unit());
+			return std::exp(mu + std::sqrt(sigma2) * normal);
+		}
+		case uniform: return std::max(mean + spread * (2.0 * rng.unit() - 1.0), 0.0);
+	}
+	return 0;
+}
+
+patientflow::patientflow(const hospital& layout, const simulationconfig& config)
+	: settings(config), rng(config.seed), feed(1 << 12), hosp("simulated " + layout.getName(), &pool), changes(feed)
+{
+	finished = false;
+	report.seed = config.seed;
+	scheduled = 0;
+	now = 0;
+	beds = 0;
+	occupied = 0;
+	bedtime = 0;
+	waitdays = 0;
+	admissions = 0;
+	for(const room* rm : layout.getRoomList())
+	{
+		rooms.emplace_back(rm -> getName(), &pool);
+		room& copy = rooms.back();
+		std::size_t capacity = rm -> getCapacity() != 0 ? rm -> getCapacity() : settings.beds;
+		copy.setCapacity(capacity);
+		hosp.addRoom(copy);
+		beds += capacity;
+		uint32_t index = copy.getHandle().index;
+		if(index >= roomat.size()) roomat.resize(index + 1, no_position);
+		roomat[index] = rooms.size() - 1;
+		open.push_back(rooms.size() - 1);
+		listed.push_back(true);
+	}
+	hosp.attachFeed(feed);
+}
+
+patientflow::~patientflow()
+{
+	hosp.detachFeed();
+}
+
+const simulationreport& patientflow::run()
+{
+	if(finished) return report;
+	finished = true;
+	schedule(settings.arrivals.sample(rng), sim_arrival, no_position);
+	while(!calendar.empty() && calendar.front().time <= settings.days)
+	{
+		calendarentry next = nextEvent();
+		advance(next.time);
+		report.events++;
+		if(next.kind == sim_arrival)
+		{
+			arrive();
+			schedule(now + settings.arrivals.sample(rng), sim_arrival, no_position);
+		}
+		else if(next.kind == sim_transfer) transfer(next.patient);
+		else discharge(next.patient);
+		collectChanges();
+	}
+	advance(settings.days);
+	report.waiting = hosp.waitlistLength(std::string_view(settings.condition));
+	report.meanwait = admissions != 0 ? waitdays / admissions : 0;
+	report.occupancy = beds != 0 && settings.days > 0 ? bedtime / (beds * settings.days) : 0;
+	return report;
+}
+
+void patientflow::schedule(double time, flowevent kind, uint32_t ptn)
+{
+	calendar.push_back({time, scheduled++, ptn, uint32_t(kind)});
+	std::push_heap(calendar.begin(), calendar.end(), laterThan<calendarentry>);
+}
+
+patientflow::calendarentry patientflow::nextEvent()
+{
+	std::pop_heap(calendar.begin(), calendar.end(), laterThan<calendarentry>);
+	calendarentry next = calendar.back();
+	calendar.pop_back();
+	return next;
+}
+
+void patientflow::advance(double time)
+{
+	bedtime += occupied * (time - now);
+	now = time;
+}
+
+void patientflow::arrive()
+{
+	report.arrivals++;
+	uint32_t position = takePatient();
+	patient& ptn = patients[position];
+	arrived[position] = now;
+	if(!hosp.registerPatient(ptn))
+	{
+		idle.push_back(position);
+		return;
+	}
+	room* rm = freeRoom(nullptr);
+	if(rm != nullptr && rm -> addPatient(ptn))
+	{
+		admitted(position);
+		return;
+	}
+	//the bed of the next patient to leave is handed over by the hospital
+	report.waited++;
+	if(!hosp.waitForBed(ptn))
+	{
+		hosp.dischargePatient(ptn);
+		idle.push_back(position);
+		return;
+	}
+	report.peakwaiting = std::max(report.peakwaiting, hosp.waitlistLength(std::string_view(settings.condition)));
+}
+
+void patientflow::transfer(uint32_t position)
+{
+	patient& ptn = patients[position];
+	room& from = ptn.getRoom();
+	room* to = freeRoom(&from);
+	//a waiting patient may take the bed left behind, the new one stays free
+	if(to != nullptr && from.removePatient(ptn) && to -> addPatient(ptn)) report.transfers++;
+	schedule(now + remaining[position], sim_discharge, position);
+}
+
+void patientflow::discharge(uint32_t position)
+{
+	hosp.dischargePatient(patients[position]);
+	report.discharges++;
+	idle.push_back(position);
+}
+
+void patientflow::admitted(uint32_t position)
+{
+	waitdays += now - arrived[position];
+	admissions++;
+	double stay = settings.stay.sample(rng);
+	if(rng.unit() < settings.transfershare)
+	{
+		remaining[position] = stay / 2;
+		schedule(now + stay / 2, sim_transfer, position);
+	}
+	else schedule(now + stay, sim_discharge, position);
+}
+
+room* patientflow::freeRoom(const room* except)
+{
+	//newest listed first, dropping the rooms found full on the way
+	for(std::size_t i = open.size(); i-- > 0;)
+	{
+		room& rm = rooms[open[i]];
+		if(rm.isFull())
+		{
+			listed[open[i]] = false;
+			open[i] = open.back();
+			open.pop_back();
+			continue;
+		}
+		if(&rm != except) return &rm;
+	}
+	return nullptr;
+}
+
+void patientflow::reopen(uint32_t position)
+{
+	if(position == no_position || listed[position] || rooms[position].isFull()) return;
+	listed[position] = true;
+	open.push_back(position);
+}
+
+void patientflow::collectChanges()
+{
+	hospitalevent evt;
+	while(changes.poll(evt))
+	{
+		if(evt.kind == event_patient_roomed) occupied++;
+		else if(evt.kind == event_patient_unroomed)
+		{
+			occupied--;
+			reopen(lookup(roomat, evt.target));
+		}
+		//a waiting patient given the bed that was freed
+		else if(evt.kind == event_patient_admitted)
+		{
+			occupied++;
+			uint32_t position = lookup(patientat, evt.subject);
+			if(position != no_position) admitted(position);
+		}
+	}
+}
+
+uint32_t patientflow::takePatient()
+{
+	if(!idle.empty())
+	{
+		uint32_t position = idle.back();
+		idle.pop_back();
+		return position;
+	}
+	//a new patient for the pool, its name stays unique as it is never renamed
+	uint32_t position = patients.size();
+	patients.emplace_back("Simulated", "Patient" + std::to_string(position), int(rng.below(100)));
+	patients.back().setCondition(settings.condition);
+	arrived.push_back(0);
+	remaining.push_back(0);
+	uint32_t index = patients.back().getHandle().index;
+	if(index >= patientat.size()) patientat.resize(index + 1, no_position);
+	patientat[index] = position;
+	return position;
+}
+
+uint32_t patientflow::lookup(const std::vector<uint32_t>& positions, entityhandle handle)
+{
+	return handle.index < positions.size() ? positions[handle.index] : no_position;
+}
+
+std::vector<simulationreport> runReplications(const hospital& layout, const simulationconfig& config, unsigned count, unsigned threads)
+{
+	std::vector<simulationreport> reports(count);
+	if(threads == 0) threads = std::thread::hardware_concurrency();
+	threads = std::clamp<unsigned>(threads, 1, std::max(count, 1u));
+	//every thread takes the next replication not started yet
+	std::atomic<unsigned> next(0);
+	auto work = [&]()
+	{
+		for(unsigned r = next++; r < count; r = next++)
+		{
+			simulationconfig seeded = config;
+			seeded.seed = config.seed + r;
+			patientflow flow(layout, seeded);
+			reports[r] = flow.run();
+		}
+	};
+	std::vector<std::thread> workers;
+	for(unsigned t = 1; t < threads; t++) workers.emplace_back(work);
+	work();
+	for(std::thread& worker : workers) worker.join();
+	return reports;
+}
@@ -0,0 +1,202 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       simulation header file
+*/
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "objects.h"
+#include "events.h"
+#include "generator.h"
+
+/*
+A random duration of a simulation, in days.
+*/
+struct distribution
+{
+	enum shape
+	{
+		//always the mean
+		fixed,
+		//memoryless, e.g. the time between arrivals
+		exponential,
+		//skewed to the right with the given standard
+		//deviation, e.g. a length of stay
+		lognormal,
+		//even within mean - spread and mean + spread
+		uniform
+	};
+	shape kind = exponential;
+	double mean = 1;
+	double spread = 0;
+
+	/*
+	Draws one value, never below 0.
+	*/
+	double sample(populationrandom& rng) const;
+};
+
+/*
+Settings of a patient flow simulation.
+*/
+struct simulationconfig
+{
+	//simulated time, in days
+	double days = 365;
+	//time between two arrivals
+	distribution arrivals = {distribution::exponential, 0.1, 0};
+	//time a patient spends in rooms before discharge
+	distribution stay = {distribution::lognormal, 5, 4};
+	//share of the patients moved to another room halfway
+	//through their stay, if another room has a free bed
+	double transfershare = 0.1;
+	//condition of the arriving patients, patients without
+	//a free bed wait for the bed of the next one to leave
+	std::string condition = "observation";
+	//beds of the layout's rooms without a limit
+	std::size_t beds = 10;
+	uint64_t seed = 2021;
+};
+
+/*
+Results of one simulation run. Times are in days.
+*/
+struct simulationreport
+{
+	uint64_t seed = 0;
+	//events taken off the calendar
+	uint64_t events = 0;
+	uint64_t arrivals = 0;
+	uint64_t discharges = 0;
+	uint64_t transfers = 0;
+	//patients that found no free bed on arrival
+	uint64_t waited = 0;
+	//patients still waiting when the time was up
+	uint64_t waiting = 0;
+	std::size_t peakwaiting = 0;
+	//mean time from arrival to a bed, over all admissions
+	double meanwait = 0;
+	//mean share of the beds taken
+	double occupancy = 0;
+};
+
+/*
+Discrete-event simulation of the patient flow through a
+hospital with the room layout of another one (names and
+capacities).
+Every arrival, transfer and discharge goes through the
+real hospital, room and patient methods, including the
+hospital's waitlists handing freed beds to waiting
+patients, which the simulation learns of from an
+event feed (see eventfeed).
+
+Events are kept on a calendar ordered by time, a binary
+heap, and equal times are taken in the order they were
+scheduled, so a run depends only on its seed.
+*/
+class patientflow
+{
+
+public:
+	/*
+	Builds the simulated hospital from the layout. The
+	layout is only read here.
+	*/
+	patientflow(const hospital& layout, const simulationconfig& config);
+	~patientflow();
+	patientflow(const patientflow&) = delete;
+	patientflow& operator=(const patientflow&) = delete;
+	/*
+	Simulates config.days and returns the results. Runs
+	once, later calls return the same report.
+	*/
+	const simulationreport& run();
+
+private:
+	//what an entry of the calendar does
+	enum flowevent
+	{
+		sim_arrival,
+		sim_transfer,
+		sim_discharge
+	};
+	struct calendarentry
+	{
+		double time;
+		//order of scheduling, breaks ties of time
+		uint64_t order;
+		uint32_t patient;
+		uint32_t kind;
+	};
+
+	simulationconfig settings;
+	simulationreport report;
+	populationrandom rng;
+	bool finished;
+	//memory of the rooms and the hospital, used by one thread only
+	std::pmr::unsynchronized_pool_resource pool;
+	//the hospital is declared after its rooms and patients, and
+	//after the feed it publishes to, so it is destroyed first
+	std::deque<room> rooms;
+	std::deque<patient> patients;
+	eventfeed feed;
+	hospital hosp;
+	eventsubscriber changes;
+
+	std::vector<calendarentry> calendar;
+	uint64_t scheduled;
+	double now;
+	//arrival time and the stay left after a transfer, by pool position
+	std::vector<double> arrived;
+	std::vector<double> remaining;
+	//pool positions of the patients not in the hospital
+	std::vector<uint32_t> idle;
+	//handle index -> position in patients or rooms
+	std::vector<uint32_t> patientat;
+	std::vector<uint32_t> roomat;
+	//rooms that may have a free bed, and whether a room is listed
+	std::vector<uint32_t> open;
+	std::vector<bool> listed;
+	//beds in total and taken, and taken beds summed over time
+	std::size_t beds;
+	std::size_t occupied;
+	double bedtime;
+	//days waited for a bed in total, and the patients given a bed
+	double waitdays;
+	uint64_t admissions;
+
+	void schedule(double time, flowevent kind, uint32_t ptn);
+	calendarentry nextEvent();
+	//moves the clock, adding up the taken beds
+	void advance(double time);
+	void arrive();
+	void transfer(uint32_t ptn);
+	void discharge(uint32_t ptn);
+	//starts the stay of a patient just put in a room
+	void admitted(uint32_t ptn);
+	//a room with a free bed other than except, nullptr if none
+	room* freeRoom(const room* except);
+	void reopen(uint32_t rm);
+	//applies what the hospital reported since the last call
+	void collectChanges();
+	uint32_t takePatient();
+	static uint32_t lookup(const std::vector<uint32_t>& positions, entityhandle handle);
+
+};
+
+/*
+Runs count independent simulations of the same layout,
+seeded config.seed, config.seed + 1 and so on, on the
+given number of threads (0 uses one per CPU). The reports
+are in seed order whatever the number of threads.
+*/
+std::vector<simulationreport> runReplications(const hospital& layout, const simulationconfig& config, unsigned count, unsigned threads = 0);
+
+#endif
@@ -0,0 +1,131 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       trace source file
+*/
+
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+//number of spans kept per thread, oldest are overwritten
+const uint64_t trace_capacity = 1 << 16;
+
+/*
+Ring buffer owned by a single recording thread.
+Buffers are never freed, so the export can still
+read spans of threads which have already finished.
+*/
+struct tracebuffer
+{
+	uint64_t tid;
+	std::atomic<uint64_t> head{0};
+	std::vector<traceevent> events;
+};
+
+/*
+Registry of all thread buffers. Function-local so it
+is constructed before the first span, even when that
+span comes from a static object in another file.
+*/
+struct traceregistry
+{
+	std::mutex lock;
+	std::vector<tracebuffer*> buffers;
+	std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+traceregistry& registry()
+{
+	static traceregistry reg;
+	return reg;
+}
+
+uint64_t traceNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - registry().epoch).count();
+}
+
+tracebuffer& localBuffer()
+{
+	thread_local tracebuffer* local = nullptr;
+	//first span of this thread, register a new buffer
+	if(local == nullptr)
+	{
+		local = new tracebuffer;
+		local -> events.resize(trace_capacity);
+		traceregistry& reg = registry();
+		std::lock_guard<std::mutex> guard(reg.lock);
+		local -> tid = reg.buffers.size() + 1;
+		reg.buffers.push_back(local);
+	}
+	return *local;
+}
+
+}
+
+tracespan::tracespan(const char* spanname)
+{
+	name = spanname;
+	start = traceNow();
+}
+
+tracespan::~tracespan()
+{
+	uint64_t end = traceNow();
+	tracebuffer& buf = localBuffer();
+	uint64_t pos = buf.head.load(std::memory_order_relaxed);
+	buf.events[pos % trace_capacity] = {name, start, end - start};
+	buf.head.store(pos + 1, std::memory_order_release);
+}
+
+void traceExport(std::ostream& str)
+{
+	traceregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	str << "{\"traceEvents\":[";
+	bool first = true;
+	for(tracebuffer* buf : reg.buffers)
+	{
+		uint64_t head = buf -> head.load(std::memory_order_acquire);
+		//only the last trace_capacity spans survive in the ring
+		uint64_t begin = head > trace_capacity ? head - trace_capacity : 0;
+		for(uint64_t i = begin; i < head; i++)
+		{
+			const traceevent& ev = buf -> events[i % trace_capacity];
+			if(!first) str << ",";
+			first = false;
+			//chrome expects microseconds, fractions are allowed
+			str << "\n{\"name\":\"" << ev.name << "\",\"ph\":\"X\",\"pid\":1"
+			<< ",\"tid\":" << buf -> tid
+			<< ",\"ts\":" << ev.start / 1000 << "." << (ev.start % 1000) / 100
+			<< ",\"dur\":" << ev.duration / 1000 << "." << (ev.duration % 1000) / 100
+			<< "}";
+		}
+	}
+	str << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+}
+
+void traceClear()
+{
+	traceregistry& reg = registry();
+	std::lock_guard<std::mutex> guard(reg.lock);
+	for(tracebuffer* buf : reg.buffers)
+		buf -> head.store(0, std::memory_order_release);
+}
+
+bool traceEnabled()
+{
+#ifdef trace_spans
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,75 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+       trace header file
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <iostream>
+#include <cstdint>
+
+/*
+Uncomment the define below to enable the
+trace span feature. It can also be enabled
+without editing with the 'make trace' target.
+When disabled, trace(...) compiles to nothing.
+*/
+//#define trace_spans
+
+#ifdef trace_spans
+#define trace(method) tracespan trace_scope(#method)
+#else
+#define trace(method)
+#endif
+
+/*
+A single finished span. Name points to a string
+literal, so no copies are made while recording.
+Times are in nanoseconds since the trace epoch.
+*/
+struct traceevent
+{
+	const char* name;
+	uint64_t start;
+	uint64_t duration;
+};
+
+/*
+A scoped span. Reads the clock on construction
+and records the elapsed time into the ring buffer
+of the calling thread on destruction.
+*/
+class tracespan
+{
+
+public:
+	tracespan(const char* spanname);
+	~tracespan();
+	tracespan(const tracespan&) = delete;
+	tracespan& operator=(const tracespan&) = delete;
+
+private:
+	const char* name;
+	uint64_t start;
+
+};
+
+/*
+Writes every span recorded so far, by every thread,
+as a Chrome trace-event JSON document. The output can
+be loaded in chrome://tracing or ui.perfetto.dev.
+Should be called while no other thread is recording.
+*/
+void traceExport(std::ostream& str);
+/*
+Drops all recorded spans from every thread buffer.
+*/
+void traceClear();
+/*
+Returns true if the build records trace spans.
+*/
+bool traceEnabled();
+
+#endif
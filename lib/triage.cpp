@@ -0,0 +1,129 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        triage source file
+*/
+
+#include "triage.h"
+#include "objects.h"
+#include "conditions.h"
+
+triagequeue::triagequeue(std::pmr::memory_resource* resource) : heap(resource), slotof(resource)
+{
+}
+
+std::size_t triagequeue::size() const
+{
+	return heap.size();
+}
+
+bool triagequeue::empty() const
+{
+	return heap.empty();
+}
+
+bool triagequeue::push(patient& ptn, uint64_t arrival)
+{
+	if(contains(ptn)) return false;
+	uint32_t index = ptn.getHandle().index;
+	if(index >= slotof.size()) slotof.resize(index + 1, no_slot);
+	heap.push_back({makeKey(ptn, arrival), &ptn});
+	slotof[index] = heap.size() - 1;
+	siftUp(heap.size() - 1);
+	return true;
+}
+
+patient* triagequeue::top() const
+{
+	if(heap.empty()) return nullptr;
+	return heap[0].ptn;
+}
+
+patient* triagequeue::pop()
+{
+	if(heap.empty()) return nullptr;
+	patient* first = heap[0].ptn;
+	removeAt(0);
+	return first;
+}
+
+bool triagequeue::update(const patient& ptn)
+{
+	if(!contains(ptn)) return false;
+	std::size_t pos = slotof[ptn.getHandle().index];
+	uint64_t arrival = heap[pos].key & ((uint64_t(1) << arrival_bits) - 1);
+	uint64_t old = heap[pos].key;
+	heap[pos].key = makeKey(ptn, arrival);
+	//more urgent moves up, less urgent moves down
+	if(heap[pos].key < old) siftUp(pos);
+	else siftDown(pos);
+	return true;
+}
+
+bool triagequeue::erase(const patient& ptn)
+{
+	if(!contains(ptn)) return false;
+	removeAt(slotof[ptn.getHandle().index]);
+	return true;
+}
+
+bool triagequeue::contains(const patient& ptn) const
+{
+	uint32_t index = ptn.getHandle().index;
+	if(index >= slotof.size() || slotof[index] == no_slot) return false;
+	return heap[slotof[index]].ptn == &ptn;
+}
+
+uint64_t triagequeue::makeKey(const patient& ptn, uint64_t arrival)
+{
+	uint64_t inverted = max_severity - ptn.getSeverity();
+	return (inverted << arrival_bits) | (arrival & ((uint64_t(1) << arrival_bits) - 1));
+}
+
+void triagequeue::place(std::size_t pos, const entry& ent)
+{
+	heap[pos] = ent;
+	slotof[ent.ptn -> getHandle().index] = pos;
+}
+
+void triagequeue::siftUp(std::size_t pos)
+{
+	entry moving = heap[pos];
+	while(pos > 0)
+	{
+		std::size_t parent = (pos - 1) / 2;
+		if(heap[parent].key <= moving.key) break;
+		place(pos, heap[parent]);
+		pos = parent;
+	}
+	place(pos, moving);
+}
+
+void triagequeue::siftDown(std::size_t pos)
+{
+	entry moving = heap[pos];
+	std::size_t count = heap.size();
+	while(true)
+	{
+		std::size_t child = 2 * pos + 1;
+		if(child >= count) break;
+		//pick the more urgent child
+		if(child + 1 < count && heap[child + 1].key < heap[child].key) child++;
+		if(moving.key <= heap[child].key) break;
+		place(pos, heap[child]);
+		pos = child;
+	}
+	place(pos, moving);
+}
+
+void triagequeue::removeAt(std::size_t pos)
+{
+	slotof[heap[pos].ptn -> getHandle().index] = no_slot;
+	entry last = heap.back();
+	heap.pop_back();
+	if(pos == heap.size()) return;
+	//fill the gap with the last entry and restore the order
+	place(pos, last);
+	if(pos > 0 && heap[(pos - 1) / 2].key > last.key) siftUp(pos);
+	else siftDown(pos);
+}
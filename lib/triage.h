@@ -0,0 +1,85 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        triage header file
+*/
+
+#ifndef TRIAGE_H
+#define TRIAGE_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+class patient;
+
+/*
+Patients waiting for treatment, ordered by urgency:
+the highest severity first, and among equal severities
+the earliest arrival. A binary heap with the heap
+position of every patient kept by its handle index, so
+top takes O(1), while push, pop, erase and update (after
+a severity change) take O(log n).
+
+Every hospital keeps one (see hospital::admitToTriage).
+*/
+class triagequeue
+{
+
+public:
+	/*
+	Starts empty, taking memory from the given resource.
+	*/
+	triagequeue(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/*
+	Returns the number of waiting patients.
+	*/
+	std::size_t size() const;
+	bool empty() const;
+	/*
+	Adds a patient with the given arrival stamp (lower
+	is earlier). Returns false if it is waiting already.
+	*/
+	bool push(patient& ptn, uint64_t arrival);
+	/*
+	Returns the most urgent patient, nullptr if none.
+	*/
+	patient* top() const;
+	/*
+	Removes and returns the most urgent patient,
+	nullptr if none.
+	*/
+	patient* pop();
+	/*
+	Moves a patient to its place after its severity
+	changed. Returns false if it is not waiting.
+	*/
+	bool update(const patient& ptn);
+	/*
+	Removes a patient, returns false if it is not waiting.
+	*/
+	bool erase(const patient& ptn);
+	bool contains(const patient& ptn) const;
+
+private:
+	//key orders by urgency: inverted severity on top, arrival below
+	struct entry
+	{
+		uint64_t key;
+		patient* ptn;
+	};
+	std::pmr::vector<entry> heap;
+	//patient handle index -> heap position, or no_slot
+	std::pmr::vector<uint32_t> slotof;
+
+	static constexpr uint32_t no_slot = UINT32_MAX;
+	static constexpr int arrival_bits = 56;
+	static uint64_t makeKey(const patient& ptn, uint64_t arrival);
+	void place(std::size_t pos, const entry& ent);
+	void siftUp(std::size_t pos);
+	void siftDown(std::size_t pos);
+	void removeAt(std::size_t pos);
+
+};
+
+#endif
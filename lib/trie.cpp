@@ -0,0 +1,211 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        surname trie source file
+*/
+
+#include "trie.h"
+#include <algorithm>
+#include <cctype>
+
+static std::pmr::string lowered(std::string_view view, std::pmr::memory_resource* resource)
+{
+	std::pmr::string str(view, resource);
+	for(char& c : str) c = std::tolower((unsigned char)c);
+	return str;
+}
+
+surnametrie::surnametrie(std::pmr::memory_resource* resource) : nodes(resource), freenodes(resource), where(resource)
+{
+	makeNode("", no_node);
+}
+
+bool surnametrie::insert(std::string_view surname, uint64_t value)
+{
+	if(where.count(value) != 0) return false;
+	//temporaries take memory from the resource of the trie too
+	std::pmr::memory_resource* resource = nodes.get_allocator().resource();
+	std::pmr::string key = lowered(surname, resource);
+	uint32_t at = 0;
+	std::size_t pos = 0;
+	while(pos < key.size())
+	{
+		uint32_t next = child(at, key[pos]);
+		//nothing shares the rest of the key, it becomes one edge
+		if(next == no_node)
+		{
+			next = makeNode(std::string_view(key).substr(pos), at);
+			attach(at, next);
+			at = next;
+			break;
+		}
+		const std::pmr::string& label = nodes[next].label;
+		std::size_t common = 1;
+		while(common < label.size() && pos + common < key.size() && label[common] == key[pos + common]) common++;
+		//the key leaves the edge halfway, split it there
+		if(common < label.size())
+		{
+			//copied first, making a node may move the label
+			std::pmr::string head(label, 0, common, resource);
+			uint32_t middle = makeNode(head, at);
+			detach(at, next);
+			attach(at, middle);
+			nodes[next].label.erase(0, common);
+			nodes[next].parent = middle;
+			attach(middle, next);
+			next = middle;
+		}
+		at = next;
+		pos += common;
+	}
+	where[value] = {at, uint32_t(nodes[at].values.size())};
+	nodes[at].values.push_back(value);
+	return true;
+}
+
+bool surnametrie::erase(uint64_t value)
+{
+	auto found = where.find(value);
+	if(found == where.end()) return false;
+	auto [at, pos] = found -> second;
+	where.erase(found);
+	//move the last value into the gap
+	std::pmr::vector<uint64_t>& values = nodes[at].values;
+	values[pos] = values.back();
+	values.pop_back();
+	if(pos < values.size()) where[values[pos]].second = pos;
+	tidy(at);
+	return true;
+}
+
+std::vector<uint64_t> surnametrie::complete(std::string_view prefix, std::size_t count) const
+{
+	std::vector<uint64_t> found;
+	std::pmr::string key = lowered(prefix, std::pmr::get_default_resource());
+	uint32_t at = 0;
+	std::size_t pos = 0;
+	while(pos < key.size())
+	{
+		at = child(at, key[pos]);
+		if(at == no_node) return found;
+		//the prefix may end halfway along the edge
+		const std::pmr::string& label = nodes[at].label;
+		std::size_t length = std::min(label.size(), key.size() - pos);
+		if(label.compare(0, length, key, pos, length) != 0) return found;
+		pos += length;
+	}
+	collect(at, count, found);
+	return found;
+}
+
+std::size_t surnametrie::size() const
+{
+	return where.size();
+}
+
+std::size_t surnametrie::nodeCount() const
+{
+	return nodes.size() - freenodes.size();
+}
+
+std::size_t surnametrie::memoryUsage() const
+{
+	std::size_t bytes = nodes.capacity() * sizeof(node) + freenodes.capacity() * sizeof(uint32_t);
+	for(const node& nd : nodes)
+	{
+		//short labels are stored inside the string object
+		const char* text = nd.label.data();
+		if(text < (const char*)&nd.label || text >= (const char*)(&nd.label + 1)) bytes += nd.label.capacity() + 1;
+		bytes += nd.children.capacity() * sizeof(uint32_t) + nd.values.capacity() * sizeof(uint64_t);
+	}
+	//buckets, plus a node with the entry, its next pointer and cached hash
+	bytes += where.bucket_count() * sizeof(void*);
+	bytes += where.size() * (sizeof(std::pair<const uint64_t, std::pair<uint32_t, uint32_t>>) + 2 * sizeof(void*));
+	return bytes;
+}
+
+uint32_t surnametrie::makeNode(std::string_view label, uint32_t parent)
+{
+	uint32_t made;
+	if(!freenodes.empty())
+	{
+		made = freenodes.back();
+		freenodes.pop_back();
+	}
+	else
+	{
+		made = nodes.size();
+		//the members of a node take memory from the same resource
+		std::pmr::polymorphic_allocator<char> alloc = nodes.get_allocator();
+		nodes.push_back({std::pmr::string(alloc), no_node, std::pmr::vector<uint32_t>(alloc), std::pmr::vector<uint64_t>(alloc)});
+	}
+	nodes[made].label = label;
+	nodes[made].parent = parent;
+	return made;
+}
+
+uint32_t surnametrie::child(uint32_t parent, char letter) const
+{
+	const std::pmr::vector<uint32_t>& kids = nodes[parent].children;
+	auto found = std::lower_bound(kids.begin(), kids.end(), (unsigned char)letter,
+		[this](uint32_t kid, unsigned char c) { return (unsigned char)nodes[kid].label[0] < c; });
+	if(found == kids.end() || nodes[*found].label[0] != letter) return no_node;
+	return *found;
+}
+
+void surnametrie::attach(uint32_t parent, uint32_t kid)
+{
+	std::pmr::vector<uint32_t>& kids = nodes[parent].children;
+	unsigned char letter = nodes[kid].label[0];
+	auto place = std::lower_bound(kids.begin(), kids.end(), letter,
+		[this](uint32_t other, unsigned char c) { return (unsigned char)nodes[other].label[0] < c; });
+	kids.insert(place, kid);
+}
+
+void surnametrie::detach(uint32_t parent, uint32_t kid)
+{
+	std::pmr::vector<uint32_t>& kids = nodes[parent].children;
+	kids.erase(std::find(kids.begin(), kids.end(), kid));
+}
+
+void surnametrie::tidy(uint32_t at)
+{
+	//the root stays, nodes ending a surname stay
+	if(at == 0 || !nodes[at].values.empty()) return;
+	uint32_t parent = nodes[at].parent;
+	if(nodes[at].children.size() > 1) return;
+	if(nodes[at].children.empty())
+	{
+		//a leaf without people goes, its parent may have to go too
+		detach(parent, at);
+		nodes[at].label.clear();
+		freenodes.push_back(at);
+		tidy(parent);
+		return;
+	}
+	//a node with a single child merges into it
+	uint32_t kid = nodes[at].children[0];
+	nodes[kid].label.insert(0, nodes[at].label);
+	nodes[kid].parent = parent;
+	//the child starts with the same letter, so it takes the same place
+	std::pmr::vector<uint32_t>& kids = nodes[parent].children;
+	*std::find(kids.begin(), kids.end(), at) = kid;
+	nodes[at].label.clear();
+	nodes[at].children.clear();
+	freenodes.push_back(at);
+}
+
+void surnametrie::collect(uint32_t at, std::size_t count, std::vector<uint64_t>& out) const
+{
+	//a surname comes before the longer ones it is a prefix of
+	for(uint64_t value : nodes[at].values)
+	{
+		if(out.size() >= count) return;
+		out.push_back(value);
+	}
+	for(uint32_t kid : nodes[at].children)
+	{
+		if(out.size() >= count) return;
+		collect(kid, count, out);
+	}
+}
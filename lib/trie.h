@@ -0,0 +1,92 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        surname trie header file
+*/
+
+#ifndef TRIE_H
+#define TRIE_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Radix trie of surnames for type-ahead search. Every edge
+carries a whole run of letters instead of a single one,
+and every node other than the root either ends a surname
+or branches, so a prefix is found in O(prefix length) and
+the N matches below it are listed in O(N). Surnames are
+lowercased, so case does not matter.
+
+Every hospital keeps one over patient surnames and one
+over staff surnames (see hospital::completePatients).
+*/
+class surnametrie
+{
+
+public:
+	/*
+	Starts with the root alone, taking memory from the
+	given resource.
+	*/
+	surnametrie(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/*
+	Adds a surname with a value identifying its person.
+	Returns false if the value is indexed already.
+	*/
+	bool insert(std::string_view surname, uint64_t value);
+	/*
+	Removes the surname of a value, returns false if it
+	is not indexed.
+	*/
+	bool erase(uint64_t value);
+	/*
+	Returns the values of up to count surnames starting
+	with prefix, in alphabetical order of the surname.
+	*/
+	std::vector<uint64_t> complete(std::string_view prefix, std::size_t count) const;
+	/*
+	Returns the number of indexed values and of nodes.
+	*/
+	std::size_t size() const;
+	std::size_t nodeCount() const;
+	/*
+	Returns an estimate of the heap memory held by the
+	trie, in bytes.
+	*/
+	std::size_t memoryUsage() const;
+
+private:
+	static constexpr uint32_t no_node = UINT32_MAX;
+	struct node
+	{
+		//letters on the edge from the parent
+		std::pmr::string label;
+		uint32_t parent;
+		//children ordered by the first letter of their label
+		std::pmr::vector<uint32_t> children;
+		//people whose surname ends here
+		std::pmr::vector<uint64_t> values;
+	};
+	//node 0 is the root, erased nodes are reused
+	std::pmr::vector<node> nodes;
+	std::pmr::vector<uint32_t> freenodes;
+	//value -> node and position among its values
+	std::pmr::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> where;
+
+	uint32_t makeNode(std::string_view label, uint32_t parent);
+	//returns the child of a node starting with letter, or no_node
+	uint32_t child(uint32_t parent, char letter) const;
+	void attach(uint32_t parent, uint32_t kid);
+	void detach(uint32_t parent, uint32_t kid);
+	//restores the invariant of a node which lost a value or a child
+	void tidy(uint32_t at);
+	void collect(uint32_t at, std::size_t count, std::vector<uint64_t>& out) const;
+
+};
+
+#endif
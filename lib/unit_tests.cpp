@@ -234,4 +234,827 @@ void testRoutine()
 	
 	cout << "\n[Dynamic memory + destructor test finished!]" << endl;
 
+	cout << "\n[testRoutine()][Synthetic population generator test:]" << endl;
+
+	populationconfig config;
+	config.patients = 200;
+	config.rooms = 5;
+	config.collisionrate = 0.05;
+	syntheticpopulation synth1(config);
+	syntheticpopulation synth2(config);
+	synth1.getHospital().printStatus(); //ok
+	cout << synth1.getCollisions() << " collisions refused" << endl; //ok
+	cout << synth1.getPatients()[7] << endl; //ok
+	cout << (synth1.getPatients()[7] == synth2.getPatients()[7]) << endl; //ok, same seed
+	config.seed = 7;
+	syntheticpopulation synth3(config);
+	cout << synth3.getPatients()[7] << endl; //ok, different seed
+	synth1.getRooms()[0].printPatients(); //ok
+
+	cout << "\n[Synthetic population generator test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Entity handle test:]" << endl;
+
+	patient* hdlp1 = new patient("Handle", "Holder", 50);
+	entityhandle hdl1 = hdlp1 -> getHandle();
+	cout << patient::fromHandle(hdl1) << endl; //ok
+	cout << (entityhandle::unpack(hdl1.pack()) == hdl1) << endl; //ok, packs into 8 bytes
+	delete hdlp1;
+	cout << patient::fromHandle(hdl1) << endl; //wrong, stale handle gives empty patient
+	patient* hdlp2 = new patient("Slot", "Reuser", 51);
+	cout << patient::fromHandle(hdl1) << endl; //wrong, reused slot is still stale
+	cout << patient::fromHandle(hdlp2 -> getHandle()) << endl; //ok
+	delete hdlp2;
+	cout << hospital::fromHandle(entityhandle()) << endl; //wrong, null handle
+	cout << room::fromHandle(synth1.getRooms()[0].getHandle()) << endl; //ok
+
+	cout << "\n[Entity handle test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Patient columns test:]" << endl;
+
+	patientcolumns cols;
+	cout << synth1.getHospital().attachColumns(cols) << endl; //ok
+	synth1.getHospital().attachColumns(cols); //wrong, already attached
+	cout << cols.size() << " rows" << endl; //ok, one per registered patient
+	cout << cols.meanAge(conditionId("influenza")) << endl; //ok
+	cout << cols.unroomedShare() << endl; //ok
+	patient& colp = synth1.getRooms()[0].getPatient("Jenny", "Lewandowski");
+	colp.setCondition("influenza");
+	colp.setAge(30);
+	synth1.getRooms()[0].removePatient(colp);
+	cout << cols.meanAge(conditionId("influenza")) << endl; //ok, row refreshed
+	cout << cols.unroomedShare() << endl; //ok, one more without a room
+	synth1.getHospital().dischargePatient(colp);
+	cout << cols.size() << " rows" << endl; //ok, one less
+	cout << synth1.getHospital().detachColumns() << endl; //ok
+	cout << cols.size() << " rows" << endl; //ok, empty
+
+	cout << "\n[Patient columns test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Census kernel test:]" << endl;
+
+	synth1.getHospital().attachColumns(cols);
+	kernellevel best = getKernelLevel();
+	setKernelLevel(kernel_scalar);
+	agestats kstats1 = ageStatsByHospital(cols, synth1.getHospital());
+	vector<uint64_t> khist1 = ageHistogram(cols, 0, 10);
+	setKernelLevel(best);
+	agestats kstats2 = ageStatsByHospital(cols, synth1.getHospital());
+	vector<uint64_t> khist2 = ageHistogram(cols, 0, 10);
+	cout << kstats2.count << " " << int(kstats2.min) << " " << int(kstats2.max) << " " << kstats2.mean << endl; //ok
+	cout << (kstats1.count == kstats2.count && kstats1.mean == kstats2.mean) << endl; //ok, levels agree
+	cout << (khist1 == khist2) << endl; //ok, levels agree
+	vector<uint64_t> kyears = ageHistogram(cols, 0, 1);
+	uint64_t kdecade = 0;
+	for(int a = 30; a < 40; a++) kdecade += kyears[a];
+	cout << kyears.size() << " " << (kdecade == khist2[3]) << endl; //ok, 201 1, a bin per year
+	cout << conditionCounts(cols, 0)[conditionId("influenza")] << " with influenza" << endl; //ok
+	cout << roomOccupancy(cols, 0)[synth1.getRooms()[0].getHandle().index] << " in room" << endl; //ok
+	cout << ageStatsByRoom(cols, 0).count << " without room" << endl; //ok
+	synth1.getHospital().detachColumns();
+
+	cout << "\n[Census kernel test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Census test:]" << endl;
+
+	synth1.getHospital().attachColumns(cols);
+	const census& cns = synth1.getHospital().getCensus();
+	cout << cns.patients() << " " << cns.healthy() << " " << cns.ill() << endl; //ok
+	cout << (cns.patients() == cols.size()) << endl; //ok, agrees with the columns
+	cout << (cns.withCondition("influenza") == conditionCounts(cols, 0)[conditionId("influenza")]) << endl; //ok
+	cout << (cns.withoutRoom() == ageStatsByRoom(cols, 0).count) << endl; //ok
+	cout << (cns.inAgeBand(3) == ageHistogram(cols, 0, census::band_width)[3]) << endl; //ok
+	cout << cns.withCondition("no such condition") << endl; //wrong, unknown condition
+	cout << cns.inAgeBand(census::band_count) << endl; //wrong, band out of range
+	patient& cnsp = synth1.getPatients()[1];
+	uint64_t cnsflu = cns.withCondition("influenza");
+	cnsp.setCondition("influenza");
+	cnsp.setCondition("influenza"); //ok, counted once
+	cout << cns.withCondition("influenza") - cnsflu << " more with influenza" << endl; //ok
+	cout << cns.rooms() << " " << cns.staffedRooms() << " " << cns.unstaffedRooms() << endl; //ok
+	room& cnsr = synth1.getRooms()[0];
+	staffmember& cnss = cnsr.getStaff();
+	bool cnsstaffed = cnss.isValid();
+	if(cnsstaffed) cnsr.unlinkStaff();
+	cout << cns.staffedRooms() << " staffed" << endl; //ok, one less if it had staff
+	if(cnsstaffed) cnsr.linkStaff(cnss);
+	cout << cns.staffedRooms() << " staffed" << endl; //ok
+	synth1.getHospital().dischargePatient(cnsp);
+	cout << cns.patients() << " " << (cns.patients() == cols.size()) << endl; //ok, one less
+	synth1.getHospital().detachColumns();
+
+	cout << "\n[Census test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Change feed test:]" << endl;
+
+	eventfeed feed(4, eventfeed::reject_newest);
+	eventsubscriber feedsub1(feed);
+	eventsubscriber feedsub2(feed);
+	hospitalevent evt;
+	cout << synth1.getHospital().attachFeed(feed) << endl; //ok
+	synth1.getHospital().attachFeed(feed); //wrong, already attached
+	patient feedp("Feed", "Watcher", 40);
+	synth1.getHospital().registerPatient(feedp);
+	synth1.getRooms()[0].addPatient(feedp);
+	//transfer shows as unroomed and roomed
+	synth1.getRooms()[0].removePatient(feedp);
+	synth1.getRooms()[1].addPatient(feedp);
+	synth1.getRooms()[1].removePatient(feedp); //wrong, ring full for feedsub2
+	cout << feed.published() << " published, " << feed.rejected() << " rejected" << endl; //ok
+	while(feedsub1.poll(evt)) cout << evt << endl; //ok
+	cout << feedsub1.poll(evt) << endl; //wrong, nothing new
+	hospitalevent feedbatch[8];
+	cout << feedsub2.pollBatch(feedbatch, 8) << " read by second subscriber" << endl; //ok
+	cout << (feedbatch[1].target == synth1.getRooms()[0].getHandle()) << endl; //ok
+	synth1.getHospital().dischargePatient(feedp);
+	cout << feedsub1.poll(evt) << " " << evt << endl; //ok
+	cout << synth1.getHospital().detachFeed() << endl; //ok
+	synth1.getHospital().detachFeed(); //wrong, nothing attached
+	eventfeed ring(2, eventfeed::overwrite_oldest);
+	eventsubscriber ringsub(ring);
+	for(int i = 0; i < 5; i++) ring.publish(event_room_added, entityhandle(), entityhandle(), entityhandle());
+	cout << ringsub.pending() << " pending" << endl; //ok
+	cout << ringsub.pollBatch(feedbatch, 8) << " read, " << ringsub.dropped() << " dropped" << endl; //ok, lagging subscriber lost the oldest
+
+	cout << "\n[Change feed test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Admission server test:]" << endl;
+
+	{
+		admissionserver srv(synth1.getHospital());
+		string srvroom = synth1.getRooms()[1].getName();
+		cout << srv.execute("REG Front Desk 33 asthma") << endl; //ok
+		cout << srv.execute("REG Front Desk 33") << endl; //wrong, already registered
+		cout << srv.execute("REG Front Desk") << endl; //wrong, no age
+		cout << srv.execute("REG Front Desker 300") << endl; //wrong, invalid age
+		cout << srv.execute("GET Front Desk") << endl; //ok
+		cout << srv.execute("MOV Front Desk " + srvroom) << endl; //ok
+		cout << srv.execute("GET Front Desk") << endl; //ok, in the room
+		cout << srv.execute("MOV Front Desk No_Such_Room") << endl; //wrong, no room
+		cout << srv.execute("MOV Front Desk -") << endl; //ok, leaves the room
+		cout << srv.execute("STAT") << endl; //ok
+		cout << srv.execute("DIS Front Desk") << endl; //ok
+		cout << srv.execute("GET Front Desk") << endl; //wrong, discharged
+		cout << srv.execute("FLY Front Desk") << endl; //wrong, unknown command
+		cout << srv.execute("REG Ann \"Smith-Jones 2\" 40") << endl; //ok, a surname with a space
+		cout << srv.execute("MOV Ann \"Smith-Jones 2\" " + srvroom) << endl; //ok
+		cout << srv.execute("GET Ann \"Smith-Jones 2\"") << endl; //ok, quoted in the answer
+		cout << srv.execute("GET Ann Smith-Jones 2") << endl; //wrong, the surname is one field
+		cout << srv.execute("DIS Ann \"Smith-Jones 2\"") << endl; //ok
+		cout << srv.execute("REG Ann \"Smith-Jones 2 40") << endl; //wrong, quote not closed
+		srv.execute("REG Left Behind 40");
+		cout << srv.served() << " requests" << endl; //ok
+	}
+	cout << synth1.getHospital().getPatient("Left", "Behind").isValid() << endl; //wrong, discharged with the server
+	{
+		//a refused move must not give the patient's bed away to a waiting one
+		hospital mvhosp("Move General");
+		room mva("A");
+		room mvb("B");
+		mvhosp.addRoom(mva);
+		mvhosp.addRoom(mvb);
+		mva.setCapacity(1);
+		mvb.setCapacity(1);
+		admissionserver mvsrv(mvhosp);
+		mvsrv.execute("REG P One 30");
+		mvsrv.execute("REG Q Two 31");
+		mvsrv.execute("REG W Wait 32");
+		mvsrv.execute("MOV P One A");
+		mvsrv.execute("MOV Q Two B");
+		mvhosp.waitForRoom(mvhosp.getPatient("W", "Wait"), mva);
+		cout << mvsrv.execute("MOV P One B") << endl; //wrong, B is full
+		cout << mvsrv.execute("MOV P One A") << endl; //wrong, already there
+		cout << mvsrv.execute("GET P One") << " " << mvhosp.waitlistLength(mva) << endl; //ok, still in A, W still waiting
+	}
+
+	cout << "\n[Admission server test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Journal replica test:]" << endl;
+
+	{
+		const char* jpath = "journal_test.log";
+		populationconfig jconfig;
+		jconfig.patients = 50;
+		jconfig.rooms = 4;
+		syntheticpopulation jsynth(jconfig);
+		patient jspaced("Spaced", "Van Der Berg", 52);
+		jspaced.setCondition("broken arm");
+		jsynth.getHospital().registerPatient(jspaced);
+		jsynth.getRooms()[0].addPatient(jspaced);
+		journalwriter jwriter(jpath);
+		cout << jwriter.isOpen() << endl; //ok
+		jwriter.snapshot(jsynth.getHospital());
+		admissionserver primary(jsynth.getHospital());
+		primary.attachJournal(jwriter);
+		string jroom = jsynth.getRooms()[2].getName();
+		primary.execute("REG Journal Entry 61 stroke");
+		primary.execute("MOV Journal Entry " + jroom);
+		primary.execute("REG Journal Entry 61"); //wrong, refused and not journaled
+		primary.execute("GET Journal Entry"); //ok, reads are not journaled
+		jwriter.flush();
+		hospital jreplicahosp("replica");
+		admissionserver replica(jreplicahosp);
+		replica.setReadOnly(true);
+		journalreader jreader(jpath);
+		jreader.poll([&](const string& record) { replica.replay(record); });
+		cout << jwriter.records() << " written, " << jreader.records() << " read" << endl; //ok
+		cout << jreplicahosp << endl; //ok, name taken from the journal
+		cout << replica.execute("GET Journal Entry") << endl; //ok
+		cout << (replica.execute("GET Spaced \"Van Der Berg\"") == primary.execute("GET Spaced \"Van Der Berg\"")) << endl; //ok, spaces survive the snapshot
+		cout << (replica.execute("STAT") == primary.execute("STAT")) << endl; //ok, same state
+		cout << replica.execute("DIS Journal Entry") << endl; //wrong, read-only
+		primary.execute("DIS Journal Entry");
+		cout << jreader.poll([&](const string& record) { replica.replay(record); }) << endl; //wrong, not flushed yet
+		jwriter.flush();
+		cout << jreader.poll([&](const string& record) { replica.replay(record); }) << endl; //ok, the discharge
+		cout << replica.execute("GET Journal Entry") << endl; //wrong, discharged on the replica as well
+		cout << (replica.execute("STAT") == primary.execute("STAT")) << endl; //ok
+		remove(jpath);
+	}
+
+	cout << "\n[Journal replica test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Command queue test:]" << endl;
+
+	{
+		deque<patient> qpatients;
+		for(int i = 0; i < 400; i++) qpatients.emplace_back("Queued", "Patient" + to_string(i), i % 90);
+		hospital qhosp("Queued General");
+		room qroom("Queue Ward");
+		qhosp.addRoom(qroom);
+		commandqueue queue(qhosp, 64);
+		vector<thread> qthreads;
+		atomic<int> qregistered(0);
+		//four producers submit a hundred registrations each
+		for(int t = 0; t < 4; t++) qthreads.emplace_back([&, t]()
+		{
+			vector<future<bool>> results;
+			for(int i = t * 100; i < t * 100 + 100; i++) results.push_back(queue.registerPatient(qpatients[i]));
+			for(future<bool>& r : results) qregistered += r.get();
+		});
+		for(thread& th : qthreads) th.join();
+		cout << qregistered << " registered" << endl; //ok
+		cout << queue.registerPatient(qpatients[0]).get() << endl; //wrong, registered already
+		future<bool> qadded = queue.addPatient(qroom, qpatients[1]);
+		future<bool> qdischarged = queue.dischargePatient(qpatients[2]);
+		cout << qadded.get() << " " << qdischarged.get() << endl; //ok
+		cout << queue.submit([](hospital& h) { return h.getCensus().patients() == 399; }).get() << endl; //ok, runs in order
+		queue.flush();
+		cout << queue.applied() << " applied" << endl; //ok
+		cout << (queue.batches() <= queue.applied()) << endl; //ok, operations share batches
+		cout << qroom.getPatient("Queued", "Patient1").isValid() << endl; //ok
+	}
+
+	cout << "\n[Command queue test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Coroutine facade test:]" << endl;
+
+	atomic<int> admitted(0);
+	{
+		deque<patient> apatients;
+		for(int i = 0; i < 1000; i++) apatients.emplace_back("Awaited", "Patient" + to_string(i), i % 90);
+		hospital ahosp("Awaited General");
+		room aroom("Awaited Ward");
+		ahosp.addRoom(aroom);
+		commandqueue aqueue(ahosp);
+		scheduler sched(2);
+		asynchospital async(aqueue, sched);
+		//a thousand logical requests in flight on two threads
+		auto admit = [&](patient& ptn) -> task<bool>
+		{
+			if(!co_await async.registerPatient(ptn)) co_return false;
+			co_return co_await async.addPatient(aroom, ptn);
+		};
+		latch adone(1000);
+		for(patient& p : apatients) spawn<bool>(sched, admit(p), [&](bool ok) { admitted += ok; adone.count_down(); });
+		census asnap = syncWait(sched, async.snapshotCensus());
+		cout << (asnap.patients() <= 1000) << endl; //ok, some may still be queued
+		//a flush would miss the room additions the coroutines start after it
+		adone.wait();
+		census afinal = syncWait(sched, async.snapshotCensus());
+		cout << afinal.patients() << " " << afinal.inRoom(aroom) << endl; //ok
+		cout << syncWait(sched, admit(apatients[0])) << endl; //wrong, registered already
+		patient alate("Late", "Patient", 50);
+		aqueue.shutdown();
+		cout << syncWait(sched, admit(alate)) << " " << ahosp.getCensus().patients() << endl; //wrong, the queue is shut down
+	}
+	//every coroutine has finished once the scheduler is gone
+	cout << admitted << " admitted" << endl; //ok
+
+	cout << "\n[Coroutine facade test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Triage queue test:]" << endl;
+
+	setConditionSeverity("stroke", 5);
+	setConditionSeverity("fracture", 2);
+	cout << setConditionSeverity("stroke", 9) << endl; //wrong, out of range
+	cout << conditionSeverity("stroke") << " " << conditionSeverity("no such condition") << endl; //ok
+	{
+		hospital thosp("Triage General");
+		patient tp1("Early", "Fracture", 30);
+		patient tp2("Later", "Fracture", 40);
+		patient tp3("Late", "Stroke", 70);
+		patient tp4("Walk", "In", 20);
+		tp1.setCondition("fracture");
+		tp2.setCondition("fracture");
+		tp3.setCondition("stroke");
+		thosp.registerPatient(tp1);
+		thosp.registerPatient(tp2);
+		thosp.registerPatient(tp3);
+		cout << tp3.getSeverity() << endl; //ok, taken from the condition
+		cout << thosp.admitToTriage(tp1) << endl; //ok
+		thosp.admitToTriage(tp1); //wrong, already waiting
+		thosp.admitToTriage(tp4); //wrong, not registered
+		thosp.admitToTriage(tp2);
+		thosp.admitToTriage(tp3);
+		cout << thosp.waitingCount() << " waiting" << endl; //ok
+		cout << thosp.peekNextPatient() << endl; //ok, stroke first
+		tp3.removeCondition();
+		cout << thosp.peekNextPatient() << endl; //ok, earliest fracture after re-prioritising
+		tp2.setSeverity(4);
+		cout << tp2.setSeverity(6) << endl; //wrong, out of range
+		cout << thosp.nextPatient() << endl; //ok, raised severity
+		thosp.dischargePatient(tp1);
+		cout << thosp.waitingCount() << " waiting" << endl; //ok, discharge left the queue
+		cout << thosp.nextPatient() << endl; //ok
+		cout << thosp.nextPatient() << endl; //wrong, nobody waiting
+		cout << thosp.leaveTriage(tp3) << endl; //wrong, not waiting
+	}
+
+	cout << "\n[Triage queue test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Room waitlist test:]" << endl;
+
+	{
+		hospital whosp("Waitlist General");
+		eventfeed wfeed(64);
+		eventsubscriber wsub(wfeed);
+		room wroom("single room");
+		room wward("fracture ward");
+		patient wp1("First", "Bed", 30);
+		patient wp2("Second", "Bed", 40);
+		patient wp3("Third", "Bed", 50);
+		patient wp4("Other", "Fracture", 60);
+		patient wp5("Next", "Fracture", 65);
+		room wopen("open ward");
+		patient wb1("First", "Burn", 20);
+		patient wb2("Second", "Burn", 21);
+		patient wb3("Third", "Burn", 22);
+		wp4.setCondition("fracture");
+		wp5.setCondition("fracture");
+		whosp.addRoom(wroom);
+		whosp.addRoom(wward);
+		wroom.setCapacity(1);
+		wward.setCapacity(1);
+		whosp.registerPatient(wp1);
+		whosp.registerPatient(wp2);
+		whosp.registerPatient(wp3);
+		whosp.registerPatient(wp4);
+		whosp.registerPatient(wp5);
+		cout << whosp.waitForRoom(wp1, wroom) << endl; //ok, free bed taken at once
+		cout << wroom.addPatient(wp2) << endl; //wrong, room is full
+		whosp.attachFeed(wfeed);
+		whosp.waitForRoom(wp2, wroom);
+		whosp.waitForRoom(wp3, wroom);
+		cout << whosp.waitForRoom(wp3, wroom) << endl; //wrong, already waiting
+		cout << whosp.waitlistLength(wroom) << " waiting for " << wroom.getName() << endl; //ok
+		wroom.removePatient(wp1);
+		cout << wp2.getRoom().getName() << ", " << whosp.waitlistLength(wroom) << " waiting" << endl; //ok, first come first served
+		whosp.dischargePatient(wp2);
+		cout << wp3.getRoom().getName() << ", " << whosp.waitlistLength(wroom) << " waiting" << endl; //ok, discharge freed the bed
+		wward.addPatient(wp4);
+		cout << whosp.waitForBed(wp5) << " " << whosp.waitForBed(wp1) << endl; //ok, wrong (healthy)
+		cout << whosp.waitlistLength("fracture") << " waiting for a fracture bed" << endl; //ok
+		wward.removePatient(wp4);
+		cout << wp5.getRoom().getName() << endl; //ok, took the bed of the same condition
+		hospitalevent evt;
+		while(wsub.poll(evt)) cout << eventName(evt.kind) << " ";
+		cout << endl; //one admitted event per hand-off
+		whosp.waitForRoom(wp1, wroom);
+		cout << whosp.leaveWaitlist(wp1) << " " << whosp.leaveWaitlist(wp1) << endl; //ok, wrong (not waiting)
+		whosp.waitForRoom(wp4, wroom);
+		wroom.setCapacity(2);
+		cout << wroom.getPatientCount() << " of " << wroom.getCapacity() << " beds taken" << endl; //ok, new bed went to wp4
+		whosp.addRoom(wopen);
+		for(patient* wb : {&wb1, &wb2, &wb3})
+		{
+			wb -> setCondition("burn");
+			whosp.registerPatient(*wb);
+		}
+		wopen.addPatient(wb1);
+		whosp.waitForBed(wb2);
+		whosp.waitForBed(wb3);
+		wopen.removePatient(wb1);
+		cout << wopen.getPatientCount() << " in " << wopen.getName() << ", " << whosp.waitlistLength("burn") << " waiting" << endl; //ok, no limit still frees one bed
+		wb3.setCondition("fracture");
+		cout << whosp.waitlistLength("burn") << " " << whosp.waitlistLength("fracture") << endl; //ok, moved to the new condition
+		wb3.removeCondition();
+		cout << whosp.waitlistLength("fracture") << " " << whosp.leaveWaitlist(wb3) << endl; //ok, wrong (left on getting well)
+		whosp.detachFeed();
+	}
+
+	cout << "\n[Room waitlist test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Fuzzy name search test:]" << endl;
+
+	cout << editDistance("kitten", "sitting", 5) << " " << editDistance("kitten", "sitting", 1) << endl; //ok, 3 and over the limit
+	{
+		hospital fhosp("Fuzzy General");
+		patient fp1("John", "Smith", 30);
+		patient fp2("Jon", "Smyth", 40);
+		patient fp3("Joan", "Smith", 50);
+		patient fp4("Mary", "Jones", 60);
+		staffmember fs1("Gregory", "House", 50);
+		fs1.setType("diagnostician");
+		fhosp.registerPatient(fp1);
+		fhosp.registerPatient(fp2);
+		fhosp.registerPatient(fp3);
+		fhosp.registerPatient(fp4);
+		fhosp.employStaff(fs1);
+		for(patient* p : fhosp.findPatients("jhon smith", 5)) cout << p -> getName() << " " << p -> getSurname() << ", ";
+		cout << endl; //ok, closest first
+		for(patient* p : fhosp.findPatients("John Smith", 1)) cout << p -> getName() << " " << p -> getSurname() << endl; //ok, exact match only
+		cout << fhosp.findPatients("Mary Jnes", 5, 0).size() << " " << fhosp.findPatients("Mary Jnes", 5, 1).size() << endl; //wrong, ok
+		cout << fhosp.findPatients("nobody at all", 5).size() << endl; //wrong, no such patient
+		for(staffmember* s : fhosp.findStaff("Greg House", 3, 3)) cout << s -> getName() << " " << s -> getSurname() << endl; //ok
+		fhosp.dischargePatient(fp1);
+		cout << fhosp.findPatients("John Smith", 5, 0).size() << endl; //wrong, discharged
+		//a name of more distinct trigrams than the shared counters count
+		std::string longname;
+		for(int i = 0; i < 200; i++) longname += std::to_string(i);
+		patient fp5("Long", longname, 20);
+		fhosp.registerPatient(fp5);
+		cout << fhosp.findPatients("Long " + longname, 5, 0).size() << " " << fhosp.findPatients("Mary Jones", 5, 0).size() << endl; //ok, 1 1
+	}
+
+	cout << "\n[Fuzzy name search test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Surname autocomplete test:]" << endl;
+
+	{
+		hospital ahosp("Autocomplete General");
+		patient ap1("Anna", "Smithson", 30);
+		patient ap2("Ben", "Smith", 40);
+		patient ap3("Carl", "Smyth", 50);
+		patient ap4("Dora", "Snow", 60);
+		patient ap5("Eve", "smith", 70);
+		staffmember as1("Fred", "Smalls", 45);
+		as1.setType("surgeon");
+		ahosp.registerPatient(ap1);
+		ahosp.registerPatient(ap2);
+		ahosp.registerPatient(ap3);
+		ahosp.registerPatient(ap4);
+		ahosp.registerPatient(ap5);
+		ahosp.employStaff(as1);
+		for(patient* p : ahosp.completePatients("sm", 10)) cout << p -> getSurname() << ", ";
+		cout << endl; //ok, alphabetical, case ignored
+		for(patient* p : ahosp.completePatients("SMITH", 2)) cout << p -> getSurname() << ", ";
+		cout << endl; //ok, first two only
+		cout << ahosp.completePatients("smo", 10).size() << " " << ahosp.completePatients("x", 10).size() << endl; //wrong, no such surnames
+		for(staffmember* s : ahosp.completeStaff("s", 10)) cout << s -> getSurname() << endl; //ok
+		ahosp.dischargePatient(ap2);
+		ahosp.dischargePatient(ap5);
+		for(patient* p : ahosp.completePatients("smi", 10)) cout << p -> getSurname() << ", ";
+		cout << endl; //ok, discharged patients left the trie
+		cout << (ahosp.surnameIndexMemory() > 0) << endl; //ok
+	}
+
+	cout << "\n[Surname autocomplete test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Compact record test:]" << endl;
+
+	{
+		shortstring shortname("Smith");
+		shortstring longname("Lewandowska-Szymanska");
+		cout << shortname << " " << shortname.isHeap() << " " << shortname.size() << endl; //ok, inline
+		cout << longname << " " << longname.isHeap() << " " << longname.size() << endl; //ok, on the heap
+		shortstring moved(std::move(longname));
+		cout << moved << " " << longname.empty() << endl; //ok, moved out
+		shortstring full("exactly fifteen");
+		cout << full << " " << full.isHeap() << " " << std::string(full.data()).size() << endl; //ok, zero terminated
+		cout << (sizeof(patient) <= 64) << endl; //ok, one cache line
+		patient cp("Maximilian", "Lewandowski-Zielinski", 250);
+		cp.setCondition("influenza");
+		cout << cp << " " << (cp.getConditionId() == conditionId("influenza")) << endl; //ok, age refused and set to 0
+		cp.removeCondition();
+		cout << cp.getConditionId() << " " << cp.getCondition().empty() << endl; //ok, healthy
+	}
+
+	cout << "\n[Compact record test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Move-aware API test:]" << endl;
+
+	{
+		patient mp("Short", "Name", 40);
+		staffmember ms("Short", "Name", 30);
+		mp.setCondition("influenza");
+		std::string longtype = "consultant anaesthesiologist";
+		std::string longroom = "paediatric intensive care unit";
+		uint64_t before = allocationCount();
+		mp.setName("Bartholomew", "Featherstonehaugh-Cholmondeley");
+		cout << allocationCount() - before << " allocation(s) for a long surname" << endl; //ok, one per long string
+		before = allocationCount();
+		mp.setCondition("influenza");
+		std::string_view mpname = mp.getName();
+		const std::string& mpcondition = mp.getCondition();
+		cout << allocationCount() - before << " allocation(s) for a known condition and the getters" << endl; //ok, none
+		cout << mpname << " " << mpcondition << endl; //ok
+		before = allocationCount();
+		ms.setType(std::move(longtype));
+		room mr(std::move(longroom));
+		cout << allocationCount() - before << " allocation(s) for moved strings" << endl; //ok, none
+		cout << ms.getType() << ", " << mr.getName() << endl; //ok
+	}
+
+	cout << "\n[Move-aware API test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Memory resource test:]" << endl;
+
+	{
+		std::vector<patient> mpatients;
+		mpatients.reserve(100);
+		for(int i = 0; i < 100; i++) mpatients.emplace_back("Mona", "Lis" + std::to_string(i), 30 + i % 50);
+		room mroom("monotonic ward");
+		//a short-lived hospital living in one buffer
+		static char buffer[1 << 18];
+		std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+		{
+			hospital mhosp("Arena Hospital", &arena);
+			uint64_t before = allocationCount();
+			bool all = mhosp.addRoom(mroom);
+			for(patient& p : mpatients) all = mhosp.registerPatient(p) && all;
+			cout << all << " " << allocationCount() - before << " global allocation(s) for 100 patients" << endl; //ok, 1 0
+			const countingresource& used = mhosp.getMemory();
+			cout << (used.bytesInUse() > 0) << " " << (used.allocations() > 100) << endl; //ok, 1 1
+			hospital mcopy(mhosp);
+			cout << (mcopy.getMemory().upstream() == &arena) << endl; //ok, 1
+			cout << mhosp.findPatients("Mona Lis42", 1).size() << " " << mhosp.completePatients("lis9", 20).size() << endl; //ok, 1 11
+		}
+		//a long-lived hospital handing freed blocks back to a pool
+		std::pmr::unsynchronized_pool_resource pool;
+		hospital phosp("Pool Hospital", &pool);
+		for(patient& p : mpatients) phosp.registerPatient(p);
+		uint64_t peak = phosp.getMemory().bytesInUse();
+		for(patient& p : mpatients) phosp.dischargePatient(p);
+		const countingresource& used = phosp.getMemory();
+		cout << (used.peakBytes() == peak) << " " << (used.bytesInUse() < peak) << endl; //ok, 1 1
+		for(patient& p : mpatients) phosp.registerPatient(p);
+		cout << phosp.getPatientList().size() << endl; //ok, 100
+	}
+
+	cout << "\n[Memory resource test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Fixed capacity test:]" << endl;
+
+	{
+		hospitallimits lims;
+		lims.rooms = 5;
+		lims.staff = 5;
+		lims.patients = 100;
+		hospital khosp("Kiosk Hospital", lims);
+		//rooms keep their patient lists in an arena of their own
+		fixedarena roomarena(1 << 16);
+		std::vector<room> krooms;
+		std::vector<staffmember> kstaff;
+		std::vector<patient> kpatients;
+		krooms.reserve(6);
+		kstaff.reserve(6);
+		kpatients.reserve(101);
+		for(int i = 0; i < 6; i++)
+		{
+			krooms.emplace_back("kiosk ward " + std::to_string(i), &roomarena);
+			krooms.back().setCapacity(10);
+			kstaff.emplace_back("Kim", "Nurse" + std::to_string(i), 40);
+			kstaff.back().setType("nurse");
+		}
+		for(int i = 0; i < 101; i++)
+		{
+			kpatients.emplace_back("Kiosk", "Visitor" + std::to_string(i), 20 + i % 60);
+			kpatients.back().setCondition(i % 2 ? "influenza" : "fracture");
+		}
+		bool added = true;
+		for(int i = 0; i < 5; i++) added = khosp.addRoom(krooms[i]) && khosp.employStaff(kstaff[i]) && added;
+		cout << added << " " << khosp.addRoom(krooms[5]) << khosp.employStaff(kstaff[5]) << endl; //ok, 1 00
+		//fills the beds, queues the rest and discharges everybody, handing the beds over
+		auto cycle = [&]()
+		{
+			bool ok = true;
+			for(int i = 0; i < 100; i++) ok = khosp.registerPatient(kpatients[i]) && ok;
+			for(int i = 0; i < 100; i++)
+			{
+				if(i < 50) ok = krooms[i / 10].addPatient(kpatients[i]) && ok;
+				else ok = khosp.waitForBed(kpatients[i]) && ok;
+			}
+			for(int i = 0; i < 100; i++) ok = khosp.dischargePatient(kpatients[i]) && ok;
+			return ok;
+		};
+		bool ok = true;
+		for(int i = 0; i < 30; i++) ok = cycle() && ok;
+		std::size_t claimed = roomarena.claimed();
+		uint64_t before = allocationCount();
+		for(int i = 0; i < 30; i++) ok = cycle() && ok;
+		cout << ok << " " << allocationCount() - before << " allocation(s) in 30 steady cycles" << endl; //ok, 1 0
+		cout << (roomarena.claimed() == claimed) << endl; //ok, 1, the freed blocks are reused
+		for(int i = 0; i < 100; i++) khosp.registerPatient(kpatients[i]);
+		cout << khosp.registerPatient(kpatients[100]) << " " << khosp.getPatientList().size() << endl; //ok, 0 100
+		cout << (khosp.getLimits().patients == 100) << " " << (hospital(khosp).getLimits().rooms == 5) << endl; //ok, 1 1
+	}
+	{
+		//no limit set, so no arena either
+		hospital uhosp("Unlimited Hospital", hospitallimits());
+		room uroom("unlimited ward");
+		patient upatient("Una", "Limited", 33);
+		cout << uhosp.addRoom(uroom) << uhosp.registerPatient(upatient) << uroom.addPatient(upatient) << " " << (uhosp.getMemory().upstream() == std::pmr::get_default_resource()) << endl; //ok, 111 1
+	}
+	{
+		//a block freed by a loosely aligned request, reused by a strict one
+		fixedarena alignarena(1 << 12);
+		void* first = alignarena.allocate(8, 8);
+		void* loose = alignarena.allocate(64, 16);
+		alignarena.deallocate(loose, 64, 16);
+		void* strict = alignarena.allocate(64, 64);
+		void* wide = alignarena.allocate(100, 8);
+		alignarena.deallocate(wide, 100, 8);
+		void* wider = alignarena.allocate(128, 128);
+		alignarena.deallocate(first, 8, 8);
+		cout << (strict == loose) << " " << (reinterpret_cast<uintptr_t>(strict) % 64) << " " << (reinterpret_cast<uintptr_t>(wider) % 128) << endl; //ok, 1 0 0
+	}
+
+	cout << "\n[Fixed capacity test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Registry policy test:]" << endl;
+
+	{
+		std::vector<patient> rpatients;
+		rpatients.reserve(20);
+		for(int i = 0; i < 20; i++) rpatients.emplace_back(i % 2 ? "Zoe" : "Adam", "Reg" + std::to_string(i), 30);
+		patient twin("Adam", "Reg0", 50);
+		//the same operations on every policy, printing the first three in iteration order
+		auto exercise = [&](auto& reg)
+		{
+			bool ok = true;
+			for(patient& p : rpatients) ok = reg.insert(p) && ok;
+			ok = !reg.insert(twin) && ok;
+			ok = reg.find({"Zoe", "Reg1"}) == &rpatients[1] && reg.find({"Zoe", "Reg0"}) == nullptr && ok;
+			ok = !reg.erase(twin) && reg.erase(rpatients[0]) && !reg.erase(rpatients[0]) && ok;
+			ok = reg.insert(twin) && reg.find({"Adam", "Reg0"}) == &twin && ok;
+			for(int i = 10; i < 20; i++) ok = reg.erase(rpatients[i]) && ok;
+			cout << ok << " " << reg.size();
+			int shown = 0;
+			for(patient* p : reg)
+				if(shown++ < 3) cout << " " << p -> getName() << " " << p -> getSurname();
+			cout << endl;
+		};
+		registry<patient, personkey, listpolicy> rlist;
+		registry<patient, personkey, vectorpolicy> rvector;
+		registry<patient, personkey, orderedpolicy> rordered;
+		registry<patient, personkey, shardedpolicy<vectorpolicy, 4>> rsharded;
+		exercise(rlist); //ok, 1 10 Zoe Reg1 Adam Reg2 Zoe Reg3
+		exercise(rvector); //ok, 1 10 Adam Reg0 Zoe Reg1 Adam Reg2, later ones moved into the gaps
+		exercise(rordered); //ok, 1 10 Adam Reg0 Adam Reg2 Adam Reg4
+		exercise(rsharded); //ok, 1 10 in shard order
+		std::size_t counted = 0;
+		for(patient* p : rsharded) counted += p != nullptr;
+		cout << counted << endl; //ok, 10
+	}
+
+	cout << "\n[Registry policy test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Validation policy test:]" << endl;
+	{
+		patient vpatient("Val", "Checked", 40);
+		//the checked policy is the default one
+		cout << vpatient.setAge(250) << vpatient.setAge<checkedinput>(-1) << " " << vpatient.getAge() << endl; //ok, 00 40
+		cout << vpatient.setName("", "Nobody") << vpatient.setCondition("") << endl; //ok, 00
+		//the trusted policy takes what it is given
+		cout << vpatient.setAge<trustedinput>(201) << " " << vpatient.getAge() << endl; //ok, 1 201
+		vpatient.setAge<trustedinput>(300);
+		cout << vpatient.getAge() << " ";
+		vpatient.setAge<trustedinput>(-5);
+		cout << vpatient.getAge() << endl; //ok, 255 0, clamped rather than wrapped
+		cout << vpatient.setCondition<trustedinput>("flu") << " " << vpatient.getCondition() << endl; //ok, 1 flu
+		staffmember vstaff("Val", "Trusted", 30);
+		hospital vhosp("validation general");
+		//the hospital employs with the default policy, which needs a profession
+		cout << vhosp.employStaff(vstaff) << " " << vstaff.getHospital().isValid() << endl; //ok, 0 0
+		cout << vhosp.employStaff<trustedinput>(vstaff) << " " << vstaff.getHospital().isValid() << endl; //ok, 1 1, the link is not checked
+		vhosp.dismissStaff(vstaff);
+		cout << vstaff.setType<trustedinput>("") << vstaff.setType("") << endl; //ok, 10
+		cout << validAge<checkedinput>(max_age) << validAge<checkedinput>(max_age + 1) << validAge<trustedinput>(max_age + 1) << endl; //ok, 101
+		static_assert(!validName<checkedinput>("", "x") && validName<trustedinput>("", "x"));
+	}
+
+	cout << "\n[Validation policy test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Key filter test:]" << endl;
+	{
+		keyfilter filter(1000, 0.01);
+		cout << filter.capacity() << " " << filter.bytes() << endl; //ok, 1001 5760, 90 blocks
+		for(uint64_t i = 0; i < 1000; i++) filter.add(nameHash("Key", std::to_string(i)));
+		bool all = true;
+		for(uint64_t i = 0; i < 1000; i++) all = filter.mayContain(nameHash("Key", std::to_string(i))) && all;
+		int falsepos = 0;
+		for(uint64_t i = 1000; i < 101000; i++) falsepos += filter.mayContain(nameHash("Key", std::to_string(i)));
+		cout << all << " " << (falsepos < 2000) << endl; //ok, 1 1, no false negatives and below 2% false positives
+		for(uint64_t i = 0; i < 500; i++) filter.remove(nameHash("Key", std::to_string(i)));
+		all = true;
+		for(uint64_t i = 500; i < 1000; i++) all = filter.mayContain(nameHash("Key", std::to_string(i))) && all;
+		cout << all << " " << filter.size() << endl; //ok, 1 500
+		//a filtered registry grows its filter past the initial size
+		std::deque<patient> fpatients;
+		registry<patient, personkey, filteredpolicy<listpolicy, 1000>> freg;
+		bool ok = true;
+		for(int i = 0; i < 300; i++)
+		{
+			fpatients.emplace_back("Filter", "Fp" + std::to_string(i), 30);
+			ok = freg.insert(fpatients.back()) && ok;
+		}
+		for(int i = 0; i < 300; i++) ok = freg.find({"Filter", "Fp" + std::to_string(i)}) == &fpatients[i] && ok;
+		ok = !freg.insert(fpatients[7]) && freg.erase(fpatients[7]) && !freg.contains({"Filter", "Fp7"}) && ok;
+		cout << ok << " " << freg.size() << " " << freg.contains({"Filter", "Fp300"}) << endl; //ok, 1 299 0
+	}
+
+	cout << "\n[Key filter test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Duplicate search test:]" << endl;
+	{
+		std::string normalised;
+		normalisedName("Anne-Marie", "O'Brien", normalised);
+		cout << normalised << endl; //ok, annemarie obrien
+		hospital dhosps[3] = {hospital("dedup north"), hospital("dedup south"), hospital("dedup east")};
+		std::deque<patient> dpatients;
+		auto admit = [&](int h, std::string_view nm, std::string_view sn, int age)
+		{
+			dpatients.emplace_back(nm, sn, age);
+			dhosps[h].registerPatient(dpatients.back());
+		};
+		admit(0, "Anna", "O'Brien", 40);
+		admit(1, "anna", "OBrien", 40);
+		admit(2, "Anna", "O Brien", 41);
+		//the same normalised name twice in one hospital is not a cross-hospital duplicate
+		admit(2, "ANNA", "OBRIEN", 40);
+		admit(0, "Ann", "Abel", 40);
+		admit(1, "Anna", "Bel", 40);
+		for(int i = 0; i < 100; i++) admit(i % 3, "Unique", "Person" + std::to_string(i), 50);
+		std::vector<const hospital*> searched = {&dhosps[0], &dhosps[1], &dhosps[2]};
+		std::vector<duplicatepair> exact = findDuplicates(searched);
+		cout << exact.size() << endl; //ok, 3, north-south, north-east and south-east at age 40
+		for(const duplicatepair& pair : exact)
+			cout << pair.firsthospital << pair.secondhospital << " " << patient::fromHandle(pair.first).getSurname() << " " << patient::fromHandle(pair.second).getSurname() << endl; //ok, 01 O'Brien OBrien, 02 O'Brien OBRIEN, 12 OBrien OBRIEN
+		dedupconfig loose;
+		loose.agetolerance = 1;
+		loose.threads = 4;
+		std::vector<duplicatepair> close = findDuplicates(searched, loose);
+		cout << close.size() << endl; //ok, 5, adds the 41 year old in the east with north and south
+		loose.threads = 1;
+		std::vector<duplicatepair> single = findDuplicates(searched, loose);
+		bool same = single.size() == close.size();
+		for(std::size_t i = 0; same && i < single.size(); i++) same = single[i].first == close[i].first && single[i].second == close[i].second;
+		cout << same << endl; //ok, 1, the same pairs in the same order on any number of threads
+	}
+
+	cout << "\n[Duplicate search test finished!]" << endl;
+
+	cout << "\n[testRoutine()][Patient flow simulation test:]" << endl;
+	{
+		std::deque<room> srooms;
+		hospital slayout("simulated layout");
+		for(int i = 0; i < 2; i++)
+		{
+			srooms.emplace_back("single " + std::to_string(i));
+			srooms.back().setCapacity(1);
+			slayout.addRoom(srooms.back());
+		}
+		//an arrival every day, each staying 3 days, in 2 beds
+		simulationconfig fixedflow;
+		fixedflow.days = 10;
+		fixedflow.arrivals = {distribution::fixed, 1, 0};
+		fixedflow.stay = {distribution::fixed, 3, 0};
+		fixedflow.transfershare = 0;
+		patientflow flow(slayout, fixedflow);
+		const simulationreport& sr = flow.run();
+		cout << sr.events << " " << sr.arrivals << " " << sr.discharges << " " << sr.transfers << endl; //ok, 15 10 5 0
+		cout << sr.waited << " " << sr.waiting << " " << sr.peakwaiting << endl; //ok, 8 3 3
+		cout << sr.meanwait << " " << sr.occupancy << endl; //ok, 1.28571 0.85, 9 days waited over 7 admissions
+		cout << slayout.getPatientList().size() << endl; //ok, 0, the layout is only read
+		//random flows with transfers, as independent replications
+		simulationconfig randomflow;
+		randomflow.days = 60;
+		randomflow.arrivals = {distribution::exponential, 1.5, 0};
+		randomflow.stay = {distribution::lognormal, 1.5, 1};
+		randomflow.transfershare = 0.5;
+		std::vector<simulationreport> serial = runReplications(slayout, randomflow, 3, 1);
+		std::vector<simulationreport> threaded = runReplications(slayout, randomflow, 3, 3);
+		bool same = true;
+		for(int i = 0; i < 3; i++)
+			same = serial[i].events == threaded[i].events && serial[i].meanwait == threaded[i].meanwait && serial[i].seed == threaded[i].seed && same;
+		cout << same << " " << serial[0].seed << serial[1].seed << serial[2].seed << endl; //ok, 1 202120222023
+		bool sane = true;
+		for(const simulationreport& r : serial)
+			sane = r.arrivals > 20 && r.discharges > 0 && r.transfers > 0 && r.occupancy > 0 && r.occupancy <= 1 && sane;
+		cout << sane << (serial[0].events != serial[1].events) << endl; //ok, 11, different seeds run differently
+	}
+
+	cout << "\n[Patient flow simulation test finished!]" << endl;
+
 }
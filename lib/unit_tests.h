@@ -9,6 +9,26 @@
 
 #include <iostream>
 #include "objects.h"
+#include "generator.h"
+#include "columns.h"
+#include "conditions.h"
+#include "kernels.h"
+#include "census.h"
+#include "events.h"
+#include "server.h"
+#include "journal.h"
+#include <cstdio>
+#include "commands.h"
+#include "async.h"
+#include "alloccount.h"
+#include "dedup.h"
+#include "simulation.h"
+#include <atomic>
+#include <deque>
+#include <future>
+#include <latch>
+#include <thread>
+#include <vector>
 
 void testRoutine();
 
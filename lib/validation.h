@@ -0,0 +1,86 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        validation header file
+*/
+
+#ifndef VALIDATION_H
+#define VALIDATION_H
+
+#include <string_view>
+
+/*
+Bounds of a valid age, see person::setAge.
+*/
+constexpr int min_age = 0;
+constexpr int max_age = 200;
+
+/*
+Validation policies of the setters. Each one says at
+compile time which rules are checked:
+
+	names		name and surname are not empty
+	ranges		the age is within [min_age;max_age]
+	text		conditions and professions are not empty
+	professions	a staffmember needs a profession to be
+			employed
+
+The checked policy enforces all of them, which is what
+interactive input needs. Ages are stored in a byte, so
+with ranges unchecked they are clamped to [0;255] rather
+than wrapped, and a negative one becomes 0.
+*/
+struct checkedinput
+{
+	static constexpr bool names = true;
+	static constexpr bool ranges = true;
+	static constexpr bool text = true;
+	static constexpr bool professions = true;
+};
+
+/*
+Checks nothing, for bulk loads of data validated before
+(e.g. a journal or a generated population). Passing it
+invalid data leaves objects in an invalid state.
+*/
+struct trustedinput
+{
+	static constexpr bool names = false;
+	static constexpr bool ranges = false;
+	static constexpr bool text = false;
+	static constexpr bool professions = false;
+};
+
+/*
+The policy used when a setter is not given one. Build
+with -Dtrusted_input to trust all input.
+*/
+#ifdef trusted_input
+using defaultvalidation = trustedinput;
+#else
+using defaultvalidation = checkedinput;
+#endif
+
+/*
+The rules themselves, always true for a rule the
+policy does not check.
+*/
+template <class Policy>
+constexpr bool validName(std::string_view namestr, std::string_view surnamestr)
+{
+	return !Policy::names || (namestr != "" && surnamestr != "");
+}
+
+template <class Policy>
+constexpr bool validAge(int agecount)
+{
+	return !Policy::ranges || (agecount >= min_age && agecount <= max_age);
+}
+
+template <class Policy>
+constexpr bool validText(std::string_view text)
+{
+	return !Policy::text || text != "";
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        waitlist source file
+*/
+
+#include "waitlist.h"
+#include "objects.h"
+
+waitlist::waitlist(std::pmr::memory_resource* resource) : queue(resource), position(resource)
+{
+}
+
+std::size_t waitlist::size() const
+{
+	return queue.size();
+}
+
+bool waitlist::empty() const
+{
+	return queue.empty();
+}
+
+bool waitlist::push(patient& ptn)
+{
+	if(contains(ptn)) return false;
+	queue.push_back(&ptn);
+	position[ptn.getHandle().index] = std::prev(queue.end());
+	return true;
+}
+
+patient* waitlist::front() const
+{
+	if(queue.empty()) return nullptr;
+	return queue.front();
+}
+
+patient* waitlist::pop()
+{
+	if(queue.empty()) return nullptr;
+	patient* first = queue.front();
+	position.erase(first -> getHandle().index);
+	queue.pop_front();
+	return first;
+}
+
+bool waitlist::erase(const patient& ptn)
+{
+	auto found = position.find(ptn.getHandle().index);
+	if(found == position.end() || *(found -> second) != &ptn) return false;
+	queue.erase(found -> second);
+	position.erase(found);
+	return true;
+}
+
+bool waitlist::contains(const patient& ptn) const
+{
+	auto found = position.find(ptn.getHandle().index);
+	return found != position.end() && *(found -> second) == &ptn;
+}
@@ -0,0 +1,65 @@
+/*
+	HOSPITAL PROJECT
+(C) Arthur Sebastian Miller 2021
+        waitlist header file
+*/
+
+#ifndef WAITLIST_H
+#define WAITLIST_H
+
+#include <cstdint>
+#include <list>
+#include <memory_resource>
+#include <unordered_map>
+
+class patient;
+
+/*
+Patients waiting for a bed, first come first served.
+A list with the position of every patient kept by its
+handle index, so push, pop and erase all take O(1).
+
+Every hospital keeps one per room and one per condition
+(see hospital::waitForRoom and hospital::waitForBed).
+*/
+class waitlist
+{
+
+public:
+	/*
+	Starts empty, taking memory from the given resource.
+	*/
+	waitlist(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/*
+	Returns the number of waiting patients.
+	*/
+	std::size_t size() const;
+	bool empty() const;
+	/*
+	Adds a patient at the back. Returns false if it is
+	waiting already.
+	*/
+	bool push(patient& ptn);
+	/*
+	Returns the patient waiting longest, nullptr if none.
+	*/
+	patient* front() const;
+	/*
+	Removes and returns the patient waiting longest,
+	nullptr if none.
+	*/
+	patient* pop();
+	/*
+	Removes a patient, returns false if it is not waiting.
+	*/
+	bool erase(const patient& ptn);
+	bool contains(const patient& ptn) const;
+
+private:
+	std::pmr::list<patient*> queue;
+	//patient handle index -> position in the queue
+	std::pmr::unordered_map<uint32_t, std::pmr::list<patient*>::iterator> position;
+
+};
+
+#endif
@@ -5,11 +5,113 @@
 */
 
 #include <iostream>
+#include <fstream>
+#include <csignal>
+#include <cstdlib>
+#include <string>
 #include "lib/objects.h"
 #include "lib/unit_tests.h"
+#include "lib/trace.h"
+#include "lib/generator.h"
+#include "lib/server.h"
+#include "lib/journal.h"
+#include "lib/loadgen.h"
 
-int main()
+/*
+Usage:
+	./run                                   runs the unit tests
+	./run --serve <socket> [patients=10000] [journal]
+	                                        serves a synthetic hospital,
+	                                        journaling its mutations
+	./run --replica <socket> <journal>      serves a read-only copy kept
+	                                        current from the journal
+	./run --load <socket> [requests=100000] [connections=4] [depth=16]
+*/
+
+//server stopped by SIGINT and SIGTERM
+admissionserver* serving = nullptr;
+
+void stopServing(int)
+{
+	if(serving != nullptr) serving -> stop();
+}
+
+int runServer(admissionserver& server, const std::string& path)
+{
+	serving = &server;
+	std::signal(SIGINT, stopServing);
+	std::signal(SIGTERM, stopServing);
+	bool served = server.serve(path);
+	serving = nullptr;
+	std::cout << server.served() << " requests served" << std::endl;
+	return served ? 0 : 1;
+}
+
+int serveMode(const std::string& path, std::size_t patients, const std::string& journalpath)
+{
+	populationconfig config;
+	config.patients = patients;
+	config.rooms = patients / 100 + 1;
+	syntheticpopulation pop(config);
+	admissionserver server(pop.getHospital());
+	journalwriter journal(journalpath != "" ? journalpath : "/dev/null");
+	if(journalpath != "")
+	{
+		if(!journal.isOpen())
+		{
+			std::cerr << "could not write " << journalpath << std::endl;
+			return 1;
+		}
+		journal.snapshot(pop.getHospital());
+		server.attachJournal(journal);
+	}
+	std::cout << "serving " << pop.getHospital() << " on " << path << std::endl;
+	return runServer(server, path);
+}
+
+int replicaMode(const std::string& path, const std::string& journalpath)
+{
+	hospital hosp("replica");
+	admissionserver server(hosp);
+	journalreader journal(journalpath);
+	server.setReadOnly(true);
+	server.followJournal(journal);
+	std::cout << "serving a replica of " << journalpath << " on " << path << std::endl;
+	int result = runServer(server, path);
+	std::cout << server.replayed() << " journal records replayed" << std::endl;
+	return result;
+}
+
+int loadMode(const std::string& path, uint64_t requests, unsigned connections, unsigned depth)
+{
+	loadreport report = runLoad(path, requests, connections, depth);
+	if(report.requests == 0)
+	{
+		std::cerr << "could not load " << path << std::endl;
+		return 1;
+	}
+	printLoadReport(std::cout, report);
+	return 0;
+}
+
+int main(int argc, char** argv)
 {
+	std::string mode = argc > 1 ? argv[1] : "";
+	if(mode == "--serve" && argc > 2)
+		return serveMode(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000, argc > 4 ? argv[4] : "");
+	if(mode == "--replica" && argc > 3)
+		return replicaMode(argv[2], argv[3]);
+	if(mode == "--load" && argc > 2)
+		return loadMode(argv[2],
+			argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100000,
+			argc > 4 ? std::atoi(argv[4]) : 4,
+			argc > 5 ? std::atoi(argv[5]) : 16);
 	testRoutine();
+	//dump recorded spans when built with 'make trace'
+	if(traceEnabled())
+	{
+		std::ofstream tracefile("trace.json");
+		traceExport(tracefile);
+	}
 	return 0;
 }